@@ -0,0 +1,328 @@
+/**
+ * @file        bench_main.cpp
+ * @brief       Micro-benchmarks for the acquisition hot paths (register decode, queues).
+ */
+
+#include "batch_structures.hpp"
+#include "register_decode.hpp"
+#include "safe_queue.hpp"
+
+#include <boost/thread/thread.hpp>
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    void print_usage(const char *argv0)
+    {
+        std::cout
+            << "Usage: " << argv0 << " [options] [benchmark...]\n"
+            << "\n"
+            << "Times the acquisition hot paths; runs every benchmark when none is named.\n"
+            << "\n"
+            << "Benchmarks:\n"
+            << "  decode                  7/8/16-float register runs: SIMD kernel vs scalar loops\n"
+            << "  queue                   SafeQueue push/pop, SPSC vs MPMC topology\n"
+            << "\n"
+            << "Options:\n"
+            << "  --iterations N          Timed calls or queued items per variant (default 5000000)\n"
+            << std::endl;
+    }
+
+    /** @brief Runs @p body @p iterations times and returns the mean nanoseconds per call. */
+    template <typename Body>
+    double time_per_call(std::uint64_t iterations, Body &&body)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (std::uint64_t i = 0; i < iterations; ++i)
+        {
+            body(i);
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+    }
+
+    void print_result(const std::string &name, double ns, double baseline_ns)
+    {
+        std::cout << "  " << std::left << std::setw(26) << name << std::right
+                  << std::fixed << std::setprecision(2) << std::setw(9) << ns << " ns"
+                  << "  x" << std::setprecision(1) << baseline_ns / ns
+                  << std::defaultfloat << std::endl;
+    }
+
+    /** @brief Inverse of @ref bms::modbus_registers_to_float: high word first. */
+    void float_to_registers(float value, std::uint16_t *words)
+    {
+        std::uint32_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        words[0] = static_cast<std::uint16_t>(bits >> 16);
+        words[1] = static_cast<std::uint16_t>(bits & 0xFFFFu);
+    }
+
+    /**
+     * @brief Makes the memory behind @p p observable, so stores to it are not dropped as
+     *        dead and the timed body is not hoisted out of the loop (GCC/Clang).
+     */
+    inline void escape(const void *p)
+    {
+        asm volatile("" : : "r"(p) : "memory");
+    }
+
+    /**
+     * @brief Decodes one float run of @p channels values (7 = board B cells, 8 = board A,
+     * 16 = temperature board) with the compiled kernel, the portable fused kernel, and
+     * the code the acquisition used before the vector decoder: a per-channel decode
+     * loop followed by a separate finite/range check pass.
+     * @details Calls cycle through a ring of distinct blocks, as after a fresh read;
+     * rewriting one register right before each call would stall the vector loads on
+     * store forwarding and skew the comparison.
+     */
+    void bench_decode_run(std::uint64_t iterations, std::size_t channels)
+    {
+        constexpr std::size_t kFirstChannel = 3;
+        constexpr std::size_t kBlocks = 64;
+
+        // Bench-like readings, with one negative and one NaN channel to exercise clamping.
+        std::vector<std::array<std::uint16_t, bms::kRegisterBlockCount>> blocks(kBlocks);
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> celsius(15.0F, 45.0F);
+        for (auto &regs : blocks)
+        {
+            for (std::size_t ch = 0; ch < channels; ++ch)
+            {
+                float value = celsius(rng);
+                if (ch == 5)
+                {
+                    value = -3.5F;
+                }
+                else if (ch == 6)
+                {
+                    value = std::numeric_limits<float>::quiet_NaN();
+                }
+                float_to_registers(value, regs.data() + kFirstChannel + 2 * ch);
+            }
+        }
+
+        bms::FloatDecodeOptions opts;
+        opts.min = 0.0F;
+        opts.max = 100.0F;
+        opts.clamp = true;
+
+        std::array<float, bms::kMaxDecodeFloats> out{};
+        bms::SampleFlags flags = bms::SampleFlags::None;
+
+        const double legacy_ns = time_per_call(iterations, [&](std::uint64_t i) {
+            const auto &regs = blocks[i % kBlocks];
+            for (std::size_t ch = 0; ch < channels; ++ch)
+            {
+                out[ch] = bms::modbus_registers_to_float(regs[kFirstChannel + 2 * ch],
+                                                         regs[kFirstChannel + 2 * ch + 1]);
+            }
+            flags = bms::SampleFlags::None;
+            for (std::size_t ch = 0; ch < channels; ++ch)
+            {
+                const float v = out[ch];
+                if (!std::isfinite(v))
+                {
+                    flags = flags | bms::SampleFlags::DecodeError;
+                }
+                else if (v < opts.min || v > opts.max)
+                {
+                    flags = flags | bms::SampleFlags::RangeError;
+                }
+                out[ch] = v > opts.min ? (v < opts.max ? v : opts.max) : opts.min;
+            }
+            escape(out.data());
+            escape(&flags);
+        });
+
+        const double scalar_ns = time_per_call(iterations, [&](std::uint64_t i) {
+            flags = bms::decode_float_words_scalar(blocks[i % kBlocks].data() + kFirstChannel, channels, out.data(), opts).flags();
+            escape(out.data());
+            escape(&flags);
+        });
+
+        const double kernel_ns = time_per_call(iterations, [&](std::uint64_t i) {
+            flags = bms::decode_float_words(blocks[i % kBlocks].data() + kFirstChannel, channels, out.data(), opts).flags();
+            escape(out.data());
+            escape(&flags);
+        });
+
+        std::cout << "[Bench][decode] " << channels << " floats per block, "
+                  << iterations << " blocks, speedup vs decode loop + check pass" << std::endl;
+        print_result("decode loop + check pass", legacy_ns, legacy_ns);
+        print_result("decode_float_words_scalar", scalar_ns, legacy_ns);
+        print_result(std::string("decode_float_words (") + bms::decode_kernel_name() + ")", kernel_ns, legacy_ns);
+    }
+
+    /** @brief Float runs of the three boards: 7 and 8 voltage cells, 16 temperatures. */
+    void bench_decode(std::uint64_t iterations)
+    {
+        for (const std::size_t channels : {std::size_t{7}, std::size_t{8}, std::size_t{16}})
+        {
+            bench_decode_run(iterations, channels);
+        }
+    }
+
+    // Queue elements are never owned here; every pointer refers to the same static item.
+    struct no_disposer
+    {
+        void operator()(int *) const noexcept {}
+    };
+
+    /** @brief Pushes and pops @p iterations items in bursts on one thread; ns per pair. */
+    template <typename Topology>
+    double queue_same_thread_ns(std::uint64_t iterations)
+    {
+        constexpr std::size_t kBurst = 512;
+        bms::SafeQueue<int, no_disposer, Topology> queue(2 * kBurst);
+        static int item = 0;
+
+        const std::uint64_t rounds = (iterations + kBurst - 1) / kBurst;
+        int *out = nullptr;
+        const double ns = time_per_call(rounds, [&](std::uint64_t) {
+            for (std::size_t i = 0; i < kBurst; ++i)
+            {
+                queue.push(&item);
+            }
+            for (std::size_t i = 0; i < kBurst; ++i)
+            {
+                queue.try_pop(out);
+            }
+        });
+        return ns / kBurst;
+    }
+
+    /**
+     * @brief One producer and one consumer thread hand over @p iterations items through
+     * a 128-slot queue with blocking push and pop; ns per item.
+     */
+    template <typename Topology>
+    double queue_handoff_ns(std::uint64_t iterations)
+    {
+        bms::SafeQueue<int, no_disposer, Topology> queue(128);
+        static int item = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        boost::thread consumer([&] {
+            int *out = nullptr;
+            for (std::uint64_t i = 0; i < iterations; ++i)
+            {
+                queue.wait_and_pop(out);
+            }
+        });
+        for (std::uint64_t i = 0; i < iterations; ++i)
+        {
+            queue.push_blocking(&item);
+        }
+        consumer.join();
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+    }
+
+    /** @brief SafeQueue cost per item for the two topologies, same thread and cross-thread. */
+    void bench_queue(std::uint64_t iterations)
+    {
+        std::cout << "[Bench][queue] " << iterations << " items, hardware threads="
+                  << boost::thread::hardware_concurrency() << ", speedup vs MPMC" << std::endl;
+
+        const double mpmc_same = queue_same_thread_ns<bms::mpmc_topology>(iterations);
+        const double spsc_same = queue_same_thread_ns<bms::spsc_topology>(iterations);
+        print_result("push+pop mpmc", mpmc_same, mpmc_same);
+        print_result("push+pop spsc", spsc_same, mpmc_same);
+
+        const double mpmc_handoff = queue_handoff_ns<bms::mpmc_topology>(iterations);
+        const double spsc_handoff = queue_handoff_ns<bms::spsc_topology>(iterations);
+        print_result("2-thread handoff mpmc", mpmc_handoff, mpmc_handoff);
+        print_result("2-thread handoff spsc", spsc_handoff, mpmc_handoff);
+    }
+
+    struct Benchmark final
+    {
+        const char *name;
+        void (*run)(std::uint64_t iterations);
+    };
+
+    constexpr std::array<Benchmark, 2> kBenchmarks{{
+        {"decode", bench_decode},
+        {"queue", bench_queue},
+    }};
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::uint64_t iterations = 5000000;
+    std::vector<std::string> selected;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help")
+        {
+            print_usage(argv[0]);
+            return 0;
+        }
+        if (arg == "--iterations")
+        {
+            if (i + 1 >= argc)
+            {
+                std::cerr << "Missing value for --iterations" << std::endl;
+                return 1;
+            }
+            try
+            {
+                iterations = std::stoull(argv[++i]);
+            }
+            catch (const std::exception &)
+            {
+                iterations = 0;
+            }
+            if (iterations == 0)
+            {
+                std::cerr << "Invalid --iterations " << argv[i] << std::endl;
+                return 1;
+            }
+            continue;
+        }
+        selected.push_back(arg);
+    }
+
+    for (const std::string &name : selected)
+    {
+        bool known = false;
+        for (const Benchmark &bench : kBenchmarks)
+        {
+            known = known || name == bench.name;
+        }
+        if (!known)
+        {
+            std::cerr << "Unknown benchmark " << name << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    for (const Benchmark &bench : kBenchmarks)
+    {
+        bool run = selected.empty();
+        for (const std::string &name : selected)
+        {
+            run = run || name == bench.name;
+        }
+        if (run)
+        {
+            bench.run(iterations);
+        }
+    }
+    return 0;
+}
@@ -40,7 +40,9 @@ namespace bms
         CommError = 1u << 0,        // MODBUS read failed
         TimestampInvalid = 1u << 1, // Device timestamp unreasonable
         DecodeError = 1u << 2,      // Float decode produced NaN/Inf
-        RangeError = 1u << 3        // Value outside physical limits
+        RangeError = 1u << 3,       // Value outside physical limits
+        Device1Missing = 1u << 4,   // Voltage device 1 half (cells 1..8) unavailable
+        Device2Missing = 1u << 5    // Voltage device 2 half (cells 9..15, current) unavailable
     };
 
     inline constexpr SampleFlags operator|(SampleFlags a, SampleFlags b) noexcept
@@ -113,6 +115,9 @@ namespace bms
         float raw_current_sensor_v{0.0F};
         float current_a{0.0F};
         std::uint64_t sequence{0};
+        std::int64_t device_skew_us{0}; // Device 2 minus device 1 sampling instant
+        std::int64_t time_uncertainty_us{0}; // Bound on |timestamp - true host time|
+        SampleFlags flags{SampleFlags::None}; // Missing halves are NaN and flagged here
     };
 
     /**
@@ -123,6 +128,22 @@ namespace bms
         std::chrono::system_clock::time_point timestamp{};
         std::array<float, kChannelCount> temperatures{};
         std::uint64_t sequence{0};
+        std::int64_t time_uncertainty_us{0}; // Bound on |timestamp - true host time|
+        SampleFlags flags{SampleFlags::None};
+    };
+
+    /**
+     * @brief Result of one timed register block read (live, or loaded from a register log).
+     */
+    struct TimedBlockRead final
+    {
+        std::array<std::uint16_t, kRegisterBlockCount> regs{};
+        std::chrono::steady_clock::time_point started{};
+        std::chrono::steady_clock::time_point finished{};
+        std::chrono::system_clock::time_point wall_started{};  // Host clock, for clock estimation
+        std::chrono::system_clock::time_point wall_finished{};
+        bool ok{false};
+        bool skipped{false}; // Circuit open: no request was sent
     };
 
     // ============================================================================
@@ -130,16 +151,30 @@ namespace bms
     // ============================================================================
 
     /**
-     * @brief Converts device epoch components into a system clock time point.
-     * @note Current implementation returns @c now() while integration is stabilized.
+     * @brief Converts device epoch components into a time point on the device's clock.
+     * @note The result is device time; map it to host time with a @ref ClockOffsetEstimator.
      */
     inline std::chrono::system_clock::time_point device_epoch_to_timepoint(
         std::uint32_t device_epoch_seconds,
         std::uint16_t subseconds_ms) noexcept
     {
         const auto base = std::chrono::system_clock::from_time_t(kUnixEpoch2000);
-        // return base + std::chrono::seconds(device_epoch_seconds) + std::chrono::milliseconds(subseconds_ms);
-        return std::chrono::system_clock::now();
+        return base + std::chrono::seconds(device_epoch_seconds) + std::chrono::milliseconds(subseconds_ms);
+    }
+
+    /**
+     * @brief Extracts the device timestamp held in registers 0-2 of a 35-register block.
+     * @note @c valid is false for an unset RTC (epoch 0) or a subsecond field >= 1000.
+     */
+    inline DeviceTimestamp decode_device_timestamp(
+        const std::array<std::uint16_t, kRegisterBlockCount> &regs) noexcept
+    {
+        DeviceTimestamp ts;
+        ts.device_epoch = (static_cast<std::uint32_t>(regs[0]) << 16) | regs[1];
+        ts.subseconds_ms = regs[2];
+        ts.valid = ts.device_epoch != 0 && ts.subseconds_ms < 1000;
+        ts.timestamp = device_epoch_to_timepoint(ts.device_epoch, ts.subseconds_ms);
+        return ts;
     }
 
     /**
@@ -181,13 +216,7 @@ namespace bms
         const std::array<std::uint16_t, kRegisterBlockCount> &regs) noexcept
     {
         // Extract timestamp (registers 0-2)
-        batch.ts.device_epoch =
-            (static_cast<std::uint32_t>(regs[0]) << 16) | regs[1];
-        batch.ts.subseconds_ms = regs[2];
-        batch.ts.timestamp = device_epoch_to_timepoint(
-            batch.ts.device_epoch,
-            batch.ts.subseconds_ms);
-        batch.ts.valid = true;
+        batch.ts = decode_device_timestamp(regs);
 
         // Extract 8 voltage channels (registers 3-34)
         for (std::size_t i = 0; i < kChannelCount / 2; ++i)
@@ -205,13 +234,7 @@ namespace bms
         TemperatureBatch &batch,
         const std::array<std::uint16_t, kRegisterBlockCount> &regs) noexcept
     {
-        batch.ts.device_epoch =
-            (static_cast<std::uint32_t>(regs[0]) << 16) | regs[1];
-        batch.ts.subseconds_ms = regs[2];
-        batch.ts.timestamp = device_epoch_to_timepoint(
-            batch.ts.device_epoch,
-            batch.ts.subseconds_ms);
-        batch.ts.valid = true;
+        batch.ts = decode_device_timestamp(regs);
 
         for (std::size_t i = 0; i < kChannelCount; ++i)
         {
@@ -226,6 +249,14 @@ namespace bms
     // Validation Utilities
     // ============================================================================
 
+    // Cell voltage limits (adjust for battery chemistry)
+    inline constexpr float kCellVoltageMinV = 2.0F;
+    inline constexpr float kCellVoltageMaxV = 4.5F;
+
+    // Battery operating range: -40°C to +85°C
+    inline constexpr float kTemperatureMinC = -40.0F;
+    inline constexpr float kTemperatureMaxC = 85.0F;
+
     inline bool is_timestamp_reasonable(
         const std::chrono::system_clock::time_point &tp) noexcept
     {
@@ -250,17 +281,13 @@ namespace bms
             result = result | SampleFlags::TimestampInvalid;
         }
 
-        // Voltage limits (adjust for battery chemistry)
-        constexpr float min_voltage = 2.0f;
-        constexpr float max_voltage = 4.5f;
-
         for (float v : batch.voltages)
         {
             if (!std::isfinite(v))
             {
                 result = result | SampleFlags::DecodeError;
             }
-            else if (v < min_voltage || v > max_voltage)
+            else if (v < kCellVoltageMinV || v > kCellVoltageMaxV)
             {
                 result = result | SampleFlags::RangeError;
             }
@@ -283,17 +310,13 @@ namespace bms
             result = result | SampleFlags::TimestampInvalid;
         }
 
-        // Battery operating range: -40°C to +85°C
-        constexpr float min_temp = -50.0f;
-        constexpr float max_temp = 100.0f;
-
         for (float t : batch.temperatures)
         {
             if (!std::isfinite(t))
             {
                 result = result | SampleFlags::DecodeError;
             }
-            else if (t < min_temp || t > max_temp)
+            else if (t < kTemperatureMinC || t > kTemperatureMaxC)
             {
                 result = result | SampleFlags::RangeError;
             }
@@ -302,4 +325,57 @@ namespace bms
         return result;
     }
 
+    // ============================================================================
+    // Alarm Classification
+    // ============================================================================
+
+    /**
+     * @brief Limits beyond which a sample is an alarm and takes the DB publisher's priority lane.
+     * @note Defaults are the limits @ref validate_voltage_batch and @ref validate_temperature_batch apply.
+     */
+    struct AlarmLimits final
+    {
+        float cell_voltage_min_v{kCellVoltageMinV};
+        float cell_voltage_max_v{kCellVoltageMaxV};
+        float temperature_max_c{kTemperatureMaxC};
+    };
+
+    /**
+     * @brief True for an under/over-voltage cell, or cells the decoder flagged out of range.
+     * @note Missing cells (NaN) are a transport problem, not an alarm.
+     */
+    inline bool is_voltage_alarm(const VoltageCurrentSample &sample, const AlarmLimits &limits) noexcept
+    {
+        if (any(sample.flags & SampleFlags::RangeError))
+        {
+            return true;
+        }
+
+        for (float v : sample.cell_voltages)
+        {
+            if (std::isfinite(v) && (v < limits.cell_voltage_min_v || v > limits.cell_voltage_max_v))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief True for a sensor reading above the operating temperature range.
+     * @note Only over-temperature alarms are possible: TemperatureAcquisition clamps
+     *       negative and NaN readings to 0 °C, so a sample never holds a value below it.
+     */
+    inline bool is_temperature_alarm(const TemperatureSample &sample, const AlarmLimits &limits) noexcept
+    {
+        for (float t : sample.temperatures)
+        {
+            if (std::isfinite(t) && t > limits.temperature_max_c)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
 } // namespace bms
@@ -0,0 +1,149 @@
+/**
+ * @file clock_sync.hpp
+ * @brief NTP-style device clock offset/drift estimation from MODBUS request timing.
+ */
+
+#pragma once
+
+#include "batch_structures.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace bms
+{
+    /**
+     * @brief Tuning for @ref ClockOffsetEstimator.
+     */
+    struct ClockEstimatorConfig final
+    {
+        std::size_t min_samples{8};             // Accepted exchanges before the estimate is valid
+        double resolution_ms{1.0};              // Device timestamp quantization (ms register)
+        double outlier_factor{4.0};             // Reject |residual| > factor * (uncertainty + half RTT)
+        double outlier_floor_ms{5.0};           // ...but never tighter than this
+        std::size_t max_consecutive_outliers{8}; // Then assume the device clock stepped and restart
+        double slot_s{2.0};                     // One (lowest-delay) exchange kept per slot
+        double min_drift_span_s{30.0};          // Observation span required before fitting drift
+    };
+
+    /**
+     * @brief Exported state of one device clock estimate.
+     * @details offset = device clock - host clock at the time of the call; drift is the
+     * device clock rate error relative to the host (positive = device runs fast).
+     */
+    struct ClockEstimate final
+    {
+        bool valid{false};
+        std::int64_t offset_us{0};
+        std::int64_t drift_ppb{0};
+        std::int64_t uncertainty_us{0};
+        std::uint64_t accepted{0};
+        std::uint64_t rejected{0};
+        std::uint64_t resets{0};
+    };
+
+    /**
+     * @brief Host-time stamp assigned to one device sample.
+     */
+    struct HostTimestamp final
+    {
+        std::chrono::system_clock::time_point time{};
+        std::int64_t uncertainty_us{0};
+        bool from_device_clock{false}; // False: fell back to the exchange midpoint
+    };
+
+    /**
+     * @brief Online offset and drift estimator for one device clock.
+     * @details Every successful block read is an NTP-like exchange: the device timestamp
+     * (registers 0-2) was taken somewhere between request send (t1) and response receipt
+     * (t4), so offset = device - (t1 + t4) / 2 with error bound (t4 - t1) / 2. The
+     * lowest-delay exchange of each @c slot_s interval enters a 64-slot window; the
+     * near-minimal-delay slots (NTP clock filter) are fitted with weighted least squares
+     * to offset(t) = offset0 + drift * (t - t0). Exchanges far off the fitted line are
+     * rejected; a run of rejections means the device clock was stepped (for example by
+     * an RTC write) and the estimator restarts.
+     * @note Not thread-safe; owned by the acquisition thread of its device.
+     */
+    class ClockOffsetEstimator final
+    {
+    public:
+        using clock = std::chrono::system_clock;
+
+        explicit ClockOffsetEstimator(ClockEstimatorConfig cfg = ClockEstimatorConfig{}) noexcept;
+
+        /**
+         * @brief Feeds one request/response exchange.
+         * @param device Device timestamp decoded from the response.
+         * @param sent Host time just before the request was sent.
+         * @param received Host time just after the response arrived.
+         * @return False when the exchange was rejected (invalid timestamp or outlier).
+         */
+        bool update(const DeviceTimestamp &device, clock::time_point sent, clock::time_point received) noexcept;
+
+        /**
+         * @brief Feeds an exchange and returns the host time of the device's sample.
+         * @details Uses the mapped device timestamp once the estimate is valid, otherwise
+         * the exchange midpoint bounded by half the round-trip time.
+         */
+        HostTimestamp stamp(const DeviceTimestamp &device, clock::time_point sent, clock::time_point received) noexcept;
+
+        /** @brief Maps a device timestamp to host time using the current fit. */
+        clock::time_point to_host_time(const DeviceTimestamp &device) const noexcept;
+
+        /** @brief True once @c min_samples exchanges have been accepted. */
+        bool valid() const noexcept { return accepted_since_reset_ >= cfg_.min_samples; }
+
+        /** @brief Error bound of mapped timestamps (microseconds). */
+        std::int64_t uncertainty_us() const noexcept;
+
+        /** @brief Snapshot of the estimate evaluated at @p at. */
+        ClockEstimate estimate(clock::time_point at = clock::now()) const noexcept;
+
+        /** @brief Discards all history, e.g. after the device clock was set. */
+        void reset() noexcept;
+
+    private:
+        static constexpr std::size_t kWindow = 64;
+
+        struct Exchange final
+        {
+            double t{0.0};        // Host midpoint, seconds since ref_
+            double offset{0.0};   // Device minus host, seconds
+            double half_rtt{0.0}; // Seconds
+        };
+
+        template <typename Fn>
+        void for_each_filtered_(double cutoff, Fn &&fn) const;
+
+        double seconds_since_ref_(clock::time_point tp) const noexcept;
+        double device_seconds_(const DeviceTimestamp &device) const noexcept;
+        double offset_at_(double t) const noexcept;
+        void refit_() noexcept;
+
+        ClockEstimatorConfig cfg_;
+        std::array<Exchange, kWindow> window_{};
+        std::size_t head_{0};
+        std::size_t size_{0};
+        Exchange pending_{};      // Best exchange of the current slot
+        double slot_start_{0.0};
+        bool has_pending_{false};
+
+        clock::time_point ref_{};
+        bool has_ref_{false};
+
+        // Current fit: offset(t) = offset0_ + drift_ * (t - t0_)
+        double offset0_{0.0};
+        double drift_{0.0};
+        double t0_{0.0};
+        double uncertainty_{0.0};
+
+        std::size_t accepted_since_reset_{0};
+        std::size_t consecutive_outliers_{0};
+        std::uint64_t accepted_{0};
+        std::uint64_t rejected_{0};
+        std::uint64_t resets_{0};
+    };
+
+} // namespace bms
@@ -7,12 +7,17 @@
 
 #include "batch_structures.hpp"
 #include "influxdb.hpp"
+#include "latency_histogram.hpp"
+#include "queue_selector.hpp"
 #include "safe_queue.hpp"
+#include "sample_broadcast.hpp"
 
 #include <array>
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 namespace bms
 {
@@ -37,20 +42,31 @@ namespace bms
         std::uint64_t write_failures{0};
         std::uint64_t threshold_flushes{0};
         std::uint64_t timer_flushes{0};
+        std::uint64_t alarm_rows_written{0};
+        std::uint64_t alarm_posts{0};
+        std::uint64_t alarm_write_failures{0};
         std::string last_error{};
     };
 
     /**
      * @brief Consumer task that drains sample queues and posts data to InfluxDB.
+     * @details Bulk telemetry is batched up to the line/byte thresholds or the flush timer.
+     * An optional alarm lane (@ref attach_alarm_lane) bypasses that batching: alarm
+     * samples are posted on their own, as soon as the task wakes for them. Alarm samples
+     * still travel the bulk path too, so a dropped or failed alarm post loses nothing;
+     * writing the same row twice is idempotent in InfluxDB.
      * @note Queue pointers are disposed by this task after serialization.
      */
     class DBPublisherTask final
     {
     public:
-        /** @brief Pointer queue type for voltage/current samples. */
-        using VoltageQueue = SafeQueue<VoltageCurrentSample>;
-        /** @brief Pointer queue type for temperature samples. */
-        using TemperatureQueue = SafeQueue<TemperatureSample>;
+        /** @brief Broadcast subscriber queue for voltage/current samples (shared, read-only). */
+        using VoltageQueue = SampleBroadcast<VoltageCurrentSample, spsc_topology>::queue_type;
+        /** @brief Broadcast subscriber queue for temperature samples (shared, read-only). */
+        using TemperatureQueue = SampleBroadcast<TemperatureSample, spsc_topology>::queue_type;
+        /** @brief Priority lane queues fed by the producers with alarm samples only. */
+        using VoltageAlarmQueue = SafeValueQueue<VoltageCurrentSample, spsc_topology>;
+        using TemperatureAlarmQueue = SafeValueQueue<TemperatureSample, spsc_topology>;
 
         /**
          * @brief Creates a publisher bound to two input queues and one HTTP client.
@@ -73,16 +89,47 @@ namespace bms
         void operator()();
         const DBPublisherDiagnostics &diagnostics() const noexcept { return diagnostics_; }
 
+        /**
+         * @brief Adds the priority alarm lane; call before the task thread starts.
+         * @details Both queues must outlive the task and be closed for it to finish.
+         */
+        void attach_alarm_lane(VoltageAlarmQueue &voltage_alarms, TemperatureAlarmQueue &temperature_alarms);
+
+        /** @brief Sample timestamp to acknowledged write, for rows posted by the alarm lane (us). */
+        LatencyPercentiles alarm_latency() const noexcept { return alarm_latency_.snapshot(); }
+        /** @brief Sample timestamp to acknowledged write, for bulk telemetry rows (us). */
+        LatencyPercentiles storage_latency() const noexcept { return storage_latency_.snapshot(); }
+
+        /** @brief Pointers moved per pop_bulk call while draining a queue; the task holds
+         *  up to this many samples outside its queue until they are serialized. */
+        static constexpr std::size_t kDrainBatch = 64;
+
     private:
+        std::size_t drain_voltage_(std::string &payload, std::size_t &lines_in_payload);
+        std::size_t drain_temperature_(std::string &payload, std::size_t &lines_in_payload);
         bool append_voltage_row_(std::string &payload, const VoltageCurrentSample &sample);
         bool append_temperature_row_(std::string &payload, const TemperatureSample &sample);
         bool flush_payload_(std::string &payload, bool threshold_flush);
+        std::size_t publish_alarms_();
+        static void record_storage_latency_(LatencyHistogram &histogram, const std::vector<std::int64_t> &row_ns);
 
         InfluxHTTPClient &client_;
         VoltageQueue &voltage_queue_;
         TemperatureQueue &temperature_queue_;
+        QueueSelector selector_;
         DBPublisherConfig cfg_;
         DBPublisherDiagnostics diagnostics_{};
+
+        // Sample timestamps (Unix ns) of the rows in the bulk payload, for storage latency.
+        std::vector<std::int64_t> payload_row_ns_;
+
+        VoltageAlarmQueue *voltage_alarms_{nullptr};
+        TemperatureAlarmQueue *temperature_alarms_{nullptr};
+        std::string alarm_payload_;
+        std::vector<std::int64_t> alarm_row_ns_;
+
+        LatencyHistogram alarm_latency_;
+        LatencyHistogram storage_latency_;
     };
 
 } // namespace bms
@@ -0,0 +1,97 @@
+/**
+ * @file event_count.hpp
+ * @brief Futex-backed eventcount: blocking waits whose notify is free when nobody waits.
+ */
+
+#pragma once
+
+#include <boost/atomic.hpp>
+
+#include <chrono>
+#include <cstdint>
+
+namespace bms
+{
+    /**
+     * @brief Lets threads sleep until a lock-free condition may have changed.
+     * @details A waiter announces itself, re-checks its condition, then sleeps on the epoch
+     * word only if the condition still fails:
+     * @code
+     *   for (;;) {
+     *       if (condition()) break;
+     *       const auto key = ec.prepare_wait();
+     *       if (condition()) { ec.cancel_wait(); break; }
+     *       ec.wait(key);
+     *   }
+     * @endcode
+     * A notifier first makes the condition true, then calls @ref notify_one or
+     * @ref notify_all. The notify fast path is a fence and one load; the epoch bump and
+     * the futex wake syscall happen only while a waiter is registered. Because
+     * @ref wait returns as soon as the epoch differs from its key, a notify that lands
+     * between @ref prepare_wait and @ref wait is never lost.
+     */
+    class EventCount final
+    {
+    public:
+        using key_type = std::uint32_t;
+
+        EventCount() = default;
+        EventCount(const EventCount &) = delete;
+        EventCount &operator=(const EventCount &) = delete;
+
+        /** @brief Registers the caller as a waiter; re-check the condition afterwards. */
+        key_type prepare_wait() noexcept
+        {
+            waiters_.fetch_add(1, boost::memory_order_seq_cst);
+            const key_type key = epoch_.load(boost::memory_order_seq_cst);
+            boost::atomic_thread_fence(boost::memory_order_seq_cst);
+            return key;
+        }
+
+        /** @brief Withdraws a @ref prepare_wait whose condition turned out to hold. */
+        void cancel_wait() noexcept
+        {
+            waiters_.fetch_sub(1, boost::memory_order_relaxed);
+        }
+
+        /** @brief Sleeps until a notify after @ref prepare_wait returned @p key. */
+        void wait(key_type key) noexcept;
+
+        /**
+         * @brief Like @ref wait, giving up at @p deadline.
+         * @return False when the deadline passed without a notify.
+         */
+        bool wait_until(key_type key, std::chrono::steady_clock::time_point deadline) noexcept;
+
+        void notify_one() noexcept
+        {
+            notify_(1);
+        }
+
+        void notify_all() noexcept
+        {
+            notify_(kWakeAll);
+        }
+
+    private:
+        static constexpr int kWakeAll = 0x7fffffff;
+
+        void notify_(int count) noexcept
+        {
+            // Pairs with the fence in prepare_wait: either the waiter sees the condition the
+            // caller just published, or this load sees the waiter.
+            boost::atomic_thread_fence(boost::memory_order_seq_cst);
+            if (waiters_.load(boost::memory_order_relaxed) != 0)
+            {
+                wake_(count);
+            }
+        }
+
+        void wake_(int count) noexcept;
+
+        // The epoch is the futex word and must be exactly 32 bits.
+        boost::atomic<std::uint32_t> epoch_{0};
+        boost::atomic<std::uint32_t> waiters_{0};
+    };
+
+} // namespace bms
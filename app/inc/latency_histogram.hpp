@@ -0,0 +1,162 @@
+/**
+ * @file latency_histogram.hpp
+ * @brief Lock-free log-linear histogram for latency percentiles in microseconds.
+ */
+
+#pragma once
+
+#include <boost/atomic.hpp>
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace bms
+{
+    /**
+     * @brief Percentile snapshot extracted from a @ref LatencyHistogram.
+     */
+    struct LatencyPercentiles final
+    {
+        std::uint64_t count{0};
+        std::uint64_t p50_us{0};
+        std::uint64_t p90_us{0};
+        std::uint64_t p99_us{0};
+        std::uint64_t max_us{0};
+    };
+
+    /**
+     * @brief Fixed-size log-linear histogram with atomic buckets.
+     * @details Each power-of-two range is split into 8 linear sub-buckets, bounding the
+     * relative error of reported percentiles to 12.5%. Recording is wait-free (one relaxed
+     * increment per bucket and total) so any thread may record concurrently with readers.
+     */
+    class LatencyHistogram final
+    {
+    public:
+        static constexpr unsigned kSubBucketBits = 3;
+        static constexpr std::size_t kSubBuckets = std::size_t{1} << kSubBucketBits;
+        static constexpr std::size_t kBucketCount = kSubBuckets * (64 - kSubBucketBits + 1);
+
+        LatencyHistogram() = default;
+        LatencyHistogram(const LatencyHistogram &) = delete;
+        LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+        /** @brief Records one latency sample in microseconds. */
+        void record(std::uint64_t value_us) noexcept
+        {
+            buckets_[bucket_index(value_us)].fetch_add(1, boost::memory_order_relaxed);
+            total_.fetch_add(1, boost::memory_order_relaxed);
+
+            std::uint64_t current_max = max_.load(boost::memory_order_relaxed);
+            while (value_us > current_max &&
+                   !max_.compare_exchange_weak(current_max, value_us,
+                                               boost::memory_order_relaxed,
+                                               boost::memory_order_relaxed))
+            {
+            }
+        }
+
+        std::uint64_t count() const noexcept
+        {
+            return total_.load(boost::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Returns the upper bound of the bucket holding quantile @p q (0..1].
+         */
+        std::uint64_t percentile(double q) const noexcept
+        {
+            const std::uint64_t total = count();
+            if (total == 0)
+            {
+                return 0;
+            }
+
+            auto rank = static_cast<std::uint64_t>(q * static_cast<double>(total) + 0.5);
+            rank = rank == 0 ? 1 : rank;
+
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i < kBucketCount; ++i)
+            {
+                seen += buckets_[i].load(boost::memory_order_relaxed);
+                if (seen >= rank)
+                {
+                    const std::uint64_t upper = bucket_upper_bound(i);
+                    const std::uint64_t observed_max = max_.load(boost::memory_order_relaxed);
+                    return upper < observed_max ? upper : observed_max;
+                }
+            }
+            return max_.load(boost::memory_order_relaxed);
+        }
+
+        LatencyPercentiles snapshot() const noexcept
+        {
+            LatencyPercentiles out;
+            out.count = count();
+            out.p50_us = percentile(0.50);
+            out.p90_us = percentile(0.90);
+            out.p99_us = percentile(0.99);
+            out.max_us = max_.load(boost::memory_order_relaxed);
+            return out;
+        }
+
+        /**
+         * @brief Halves every bucket so recent samples dominate (streaming estimate).
+         * @note Not atomic as a whole; concurrent records may be partially aged.
+         */
+        void decay() noexcept
+        {
+            std::uint64_t remaining = 0;
+            for (auto &bucket : buckets_)
+            {
+                const std::uint64_t halved = bucket.load(boost::memory_order_relaxed) / 2;
+                bucket.store(halved, boost::memory_order_relaxed);
+                remaining += halved;
+            }
+            total_.store(remaining, boost::memory_order_relaxed);
+            max_.store(remaining > 0 ? percentile(1.0) : 0, boost::memory_order_relaxed);
+        }
+
+        void reset() noexcept
+        {
+            for (auto &bucket : buckets_)
+            {
+                bucket.store(0, boost::memory_order_relaxed);
+            }
+            total_.store(0, boost::memory_order_relaxed);
+            max_.store(0, boost::memory_order_relaxed);
+        }
+
+        static constexpr std::size_t bucket_index(std::uint64_t value) noexcept
+        {
+            if (value < kSubBuckets)
+            {
+                return static_cast<std::size_t>(value);
+            }
+            const unsigned exponent = static_cast<unsigned>(std::bit_width(value)) - 1u;
+            const unsigned shift = exponent - kSubBucketBits;
+            const std::size_t sub = static_cast<std::size_t>((value >> shift) & (kSubBuckets - 1));
+            return (static_cast<std::size_t>(shift) + 1u) * kSubBuckets + sub;
+        }
+
+        static constexpr std::uint64_t bucket_upper_bound(std::size_t index) noexcept
+        {
+            if (index < kSubBuckets)
+            {
+                return index;
+            }
+            const unsigned shift = static_cast<unsigned>(index / kSubBuckets) - 1u;
+            const std::uint64_t sub = index % kSubBuckets;
+            const std::uint64_t lower = (kSubBuckets + sub) << shift;
+            return lower + ((std::uint64_t{1} << shift) - 1u);
+        }
+
+    private:
+        std::array<boost::atomic<std::uint64_t>, kBucketCount> buckets_{};
+        boost::atomic<std::uint64_t> total_{0};
+        boost::atomic<std::uint64_t> max_{0};
+    };
+
+} // namespace bms
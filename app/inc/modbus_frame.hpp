@@ -0,0 +1,162 @@
+/**
+ * @file modbus_frame.hpp
+ * @brief MODBUS/TCP application data unit (MBAP + PDU) encode/decode helpers.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bms
+{
+
+    // ============================================================================
+    // MODBUS/TCP Protocol Constants
+    // ============================================================================
+
+    inline constexpr std::size_t kMbapHeaderSize = 7;         // tid(2) + pid(2) + len(2) + unit(1)
+    inline constexpr std::size_t kMaxAduSize = 260;           // MBAP header + 253-byte PDU
+    inline constexpr std::size_t kMaxReadRegisters = 125;     // PDU limit for function 0x03/0x04
+    inline constexpr std::size_t kReadRequestAduSize = 12;    // MBAP header + fc + addr + count
+
+    inline constexpr std::uint8_t kFcReadHoldingRegisters = 0x03;
+    inline constexpr std::uint8_t kFcReadInputRegisters = 0x04;
+    inline constexpr std::uint8_t kFcWriteMultipleRegisters = 0x10;
+    inline constexpr std::size_t kMaxWriteRegisters = 123;    // PDU limit for function 0x10
+    inline constexpr std::uint8_t kExceptionBit = 0x80;
+
+    /**
+     * @brief Decoded MBAP header fields.
+     */
+    struct MbapHeader final
+    {
+        std::uint16_t transaction_id{0};
+        std::uint16_t protocol_id{0};
+        std::uint16_t length{0}; // Unit ID + PDU bytes
+        std::uint8_t unit_id{0};
+    };
+
+    /**
+     * @brief Outcome of decoding one response ADU.
+     */
+    enum class FrameStatus : std::uint8_t
+    {
+        Ok,        // Register payload decoded into destination
+        Exception, // Device answered with a MODBUS exception PDU
+        Malformed  // Header/PDU inconsistent with the request
+    };
+
+    // ============================================================================
+    // Encoding
+    // ============================================================================
+
+    inline void put_be16(std::uint8_t *out, std::uint16_t value) noexcept
+    {
+        out[0] = static_cast<std::uint8_t>(value >> 8);
+        out[1] = static_cast<std::uint8_t>(value & 0xFFu);
+    }
+
+    inline std::uint16_t get_be16(const std::uint8_t *in) noexcept
+    {
+        return static_cast<std::uint16_t>((static_cast<std::uint16_t>(in[0]) << 8) | in[1]);
+    }
+
+    /**
+     * @brief Encodes a read-registers request ADU (function 0x03 or 0x04).
+     * @param out Destination buffer of at least @ref kReadRequestAduSize bytes.
+     * @return Number of bytes written.
+     */
+    inline std::size_t build_read_request(
+        std::uint8_t *out,
+        std::uint16_t transaction_id,
+        std::uint8_t unit_id,
+        std::uint8_t function,
+        std::uint16_t address,
+        std::uint16_t count) noexcept
+    {
+        put_be16(out + 0, transaction_id);
+        put_be16(out + 2, 0);  // Protocol ID: MODBUS
+        put_be16(out + 4, 6);  // Unit ID + 5-byte PDU
+        out[6] = unit_id;
+        out[7] = function;
+        put_be16(out + 8, address);
+        put_be16(out + 10, count);
+        return kReadRequestAduSize;
+    }
+
+    // ============================================================================
+    // Decoding
+    // ============================================================================
+
+    /**
+     * @brief Decodes an MBAP header from at least @ref kMbapHeaderSize bytes.
+     * @return False when the protocol ID or length field cannot describe a valid ADU.
+     */
+    inline bool parse_mbap_header(const std::uint8_t *in, MbapHeader &out) noexcept
+    {
+        out.transaction_id = get_be16(in + 0);
+        out.protocol_id = get_be16(in + 2);
+        out.length = get_be16(in + 4);
+        out.unit_id = in[6];
+
+        // Length covers unit ID plus at least a function code and one more byte.
+        return out.protocol_id == 0 &&
+               out.length >= 3 &&
+               out.length <= (kMaxAduSize - 6);
+    }
+
+    /**
+     * @brief Total ADU size in bytes described by a decoded header.
+     */
+    inline std::size_t adu_size(const MbapHeader &header) noexcept
+    {
+        return 6u + static_cast<std::size_t>(header.length);
+    }
+
+    /**
+     * @brief Decodes a read-registers response ADU into host-order register words.
+     * @param adu Complete ADU starting at the MBAP header.
+     * @param size ADU size in bytes (as returned by @ref adu_size).
+     * @param function Function code of the matching request.
+     * @param count Number of registers requested.
+     * @param dest Destination for @p count register words.
+     * @param exception_code Receives the exception code on @ref FrameStatus::Exception.
+     */
+    inline FrameStatus parse_read_response(
+        const std::uint8_t *adu,
+        std::size_t size,
+        std::uint8_t function,
+        std::uint16_t count,
+        std::uint16_t *dest,
+        std::uint8_t &exception_code) noexcept
+    {
+        if (size < kMbapHeaderSize + 2)
+        {
+            return FrameStatus::Malformed;
+        }
+
+        const std::uint8_t *pdu = adu + kMbapHeaderSize;
+        if (pdu[0] == (function | kExceptionBit))
+        {
+            exception_code = pdu[1];
+            return FrameStatus::Exception;
+        }
+
+        const std::size_t byte_count = 2u * count;
+        if (pdu[0] != function ||
+            pdu[1] != byte_count ||
+            size != kMbapHeaderSize + 2 + byte_count)
+        {
+            return FrameStatus::Malformed;
+        }
+
+        const std::uint8_t *data = pdu + 2;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            dest[i] = get_be16(data + 2 * i);
+        }
+        return FrameStatus::Ok;
+    }
+
+} // namespace bms
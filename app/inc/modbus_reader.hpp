@@ -6,11 +6,22 @@
 #pragma once
 
 #include "batch_structures.hpp"
+#include "latency_histogram.hpp"
+#include "modbus_frame.hpp"
+
+#include <boost/atomic.hpp>
+#include <boost/thread/thread.hpp>
 
 #include <string>
 #include <cstdint>
 #include <array>
 #include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <span>
+#include <vector>
 
 namespace bms
 {
@@ -32,8 +43,67 @@ namespace bms
         // Retry policy
         int connect_retries{3};
         int read_retries{2};
+
+        // Maximum outstanding transactions for pipelined reads (1 disables pipelining)
+        int pipeline_window{1};
+        // Pipelined batches in a row that break the protocol (unknown transaction or unit
+        // IDs, bad MBAP headers, malformed responses) before the window drops to 1. The
+        // configured window is probed again after the cooldown or the next reconnect.
+        int pipeline_violation_threshold{3};
+        int pipeline_reprobe_after_s{300};
+
+        // Share one TCP connection with every other client of the same host:port that
+        // also sets this (several unit IDs behind one gateway). See ModbusGateway.
+        bool share_connection{false};
+
+        // Take response arrival times from the kernel (SO_TIMESTAMPNS) instead of after the
+        // read returns. Reads are then framed and received by this client, not libmodbus.
+        bool kernel_timestamps{false};
+
+        // RTT-adaptive response timeout: clamp(p99 RTT x multiplier, floor, ceiling).
+        // The static response timeout above applies until enough samples are collected.
+        bool adaptive_timeout{true};
+        double adaptive_timeout_multiplier{3.0};
+        int adaptive_timeout_floor_ms{20};
+        int adaptive_timeout_ceiling_ms{1000};
+        std::uint32_t adaptive_min_samples{32};
+        std::uint32_t adaptive_retune_every{16}; // Successful reads between retunes
+        std::uint32_t rtt_decay_every{1024};     // Samples before halving the histogram
+
+        // Circuit breaker: after breaker_failure_threshold consecutive failed reads (or a
+        // lost link) the circuit opens, reads fail fast, and a background thread
+        // reconnects with exponential backoff and +/- jitter.
+        bool background_reconnect{true};
+        int breaker_failure_threshold{3};
+        int reconnect_backoff_initial_ms{250};
+        int reconnect_backoff_max_ms{30000};
+        double reconnect_backoff_jitter{0.2};
+    };
+
+    /**
+     * @brief Circuit-breaker state of one MODBUS device.
+     */
+    enum class CircuitState : std::uint8_t
+    {
+        Closed,  // Connected; reads go through
+        Open,    // Device considered down; reads fail fast while reconnecting in background
+        HalfOpen // Fresh connection on probation; the next read decides
     };
 
+    inline const char *to_string(CircuitState state) noexcept
+    {
+        switch (state)
+        {
+        case CircuitState::Closed:
+            return "closed";
+        case CircuitState::Open:
+            return "open";
+        case CircuitState::HalfOpen:
+            return "half_open";
+        }
+        return "unknown";
+    }
+
     /**
      * @brief Mutable counters and last-error fields for MODBUS operations.
      */
@@ -45,10 +115,105 @@ namespace bms
         std::uint64_t read_failures{0};
         std::uint64_t reconnects{0};
         std::uint64_t successful_reads{0};
+        std::uint64_t write_failures{0};
+        std::uint64_t successful_writes{0};
+        std::uint64_t kernel_rx_timestamps{0}; // Responses stamped by the kernel
+        std::uint64_t stream_resyncs{0};       // Links replaced after unexpected trailing bytes
+
+        // Pipelining
+        std::uint64_t pipelined_batches{0};
+        std::uint64_t pipeline_violations{0}; // Batches that broke the protocol
+        std::uint64_t pipeline_fallbacks{0};
+        std::uint64_t pipeline_reprobes{0};
+        int effective_pipeline_window{1};
+
+        // Round-trip latency and derived timeout
+        std::uint64_t timeouts{0};
+        LatencyPercentiles rtt{};
+        std::int64_t response_timeout_ms{0};
+
+        // Circuit breaker
+        CircuitState circuit_state{CircuitState::Closed};
+        std::uint64_t circuit_opens{0};
+        std::uint64_t fast_failures{0}; // Reads rejected while the circuit was open
+        std::uint64_t background_connect_attempts{0};
+    };
+
+    /**
+     * @brief One register read inside a pipelined batch.
+     */
+    struct ModbusReadRequest final
+    {
+        std::uint8_t function{kFcReadInputRegisters}; // 0x03 or 0x04
+        int addr{0};
+        int count{0};
+        std::uint16_t *dest{nullptr};
+        bool ok{false}; // Set when the response was received and decoded
+        std::chrono::system_clock::time_point received{}; // Response arrival (kernel time when enabled)
+    };
+
+    /**
+     * @brief Host-clock times of the last successful request/response exchange.
+     * @details @c sent is taken just before the request is written, after any queuing
+     * behind a shared gateway. @c received is the kernel receive timestamp of the
+     * response's last segment when @c kernel_rx is set, otherwise the time the read
+     * returned.
+     */
+    struct ModbusExchangeTimes final
+    {
+        std::chrono::system_clock::time_point sent{};
+        std::chrono::system_clock::time_point received{};
+        bool kernel_rx{false};
+    };
+
+    /**
+     * @brief One MODBUS/TCP connection shared by several unit IDs behind a gateway.
+     * @details Clients configured with @c share_connection borrow the gateway's link
+     * for each transaction or pipelined batch, under the gateway's lock, and address
+     * their own unit ID; N devices behind one gateway then cost one socket and one
+     * handshake. Each client keeps its own retries, RTT histogram, adaptive timeout
+     * and circuit breaker: a unit that stops answering opens only its own circuit,
+     * while a transport failure drops the link for every unit and whichever client
+     * needs it next reconnects it.
+     */
+    class ModbusGateway final
+    {
+    public:
+        ModbusGateway(std::string host, int port);
+        ~ModbusGateway();
+
+        ModbusGateway(const ModbusGateway &) = delete;
+        ModbusGateway &operator=(const ModbusGateway &) = delete;
+
+        /**
+         * @brief Returns the process-wide gateway for @p host:@p port, creating it on first use.
+         * @details The gateway lives as long as any client holds it (thread-safe).
+         */
+        static std::shared_ptr<ModbusGateway> acquire(const std::string &host, int port);
+
+        const std::string &host() const noexcept { return host_; }
+        int port() const noexcept { return port_; }
+        bool is_connected() const noexcept { return connected_.load(); }
+        /** @brief TCP connections opened so far; stays at 1 while the link holds. */
+        std::uint64_t connects() const noexcept { return connects_.load(); }
+
+    private:
+        friend class ModbusTcpClient;
+
+        std::string host_;
+        int port_;
+        std::mutex mutex_;  // One transaction (or pipelined batch) on the socket at a time
+        void *ctx_{nullptr}; // Opaque modbus_t*, guarded by mutex_
+        boost::atomic<bool> connected_{false};
+        std::uint16_t next_transaction_id_{0x8000}; // Unique across the units in flight
+        boost::atomic<std::uint64_t> connects_{0};
     };
 
     /**
      * @brief Thin libmodbus wrapper with reconnect and retry behavior.
+     * @details With @c background_reconnect enabled, the read path never blocks in
+     * @c modbus_connect: a per-client helper thread owns reconnect attempts and hands a
+     * connected context back through an atomic slot picked up on the next read.
      */
     class ModbusTcpClient final
     {
@@ -65,12 +230,14 @@ namespace bms
         ModbusTcpClient &operator=(const ModbusTcpClient &) = delete;
 
         /**
-         * @brief Opens a MODBUS/TCP connection.
+         * @brief Opens a MODBUS/TCP connection (blocking, up to @c connect_retries attempts).
          * @return True when session setup succeeds.
+         * @note On failure with background reconnect enabled, the circuit opens and
+         *       reconnection continues off the caller's thread.
          */
         bool connect();
         /**
-         * @brief Closes and frees the active MODBUS context.
+         * @brief Closes and frees the active MODBUS context and cancels background reconnects.
          */
         void disconnect();
         /**
@@ -86,6 +253,38 @@ namespace bms
          * @return True on successful full-length read.
          */
         bool read_input_registers(int addr, int count, std::uint16_t *dest);
+        /** @brief Same as @ref read_input_registers for holding registers (function 0x03). */
+        bool read_holding_registers(int addr, int count, std::uint16_t *dest);
+
+        /**
+         * @brief Writes a contiguous block of holding registers (function 0x10).
+         * @details Unlike reads, a failed write is not retried: the caller usually encodes
+         * time-dependent values and must recompute them before trying again.
+         * @param addr Starting register address.
+         * @param count Number of registers to write, at most @ref kMaxWriteRegisters.
+         * @param src Source buffer of at least @p count entries.
+         * @return True when the device acknowledged all @p count registers.
+         */
+        bool write_registers(int addr, int count, const std::uint16_t *src);
+
+        /**
+         * @brief Reads several register ranges with up to @c pipeline_window requests in flight.
+         * @details Responses are matched by MBAP transaction ID and may arrive out of order.
+         * A timeout is counted like a sequential one and the unanswered ranges are retried
+         * one at a time. When the stream has to be dropped (a transport error or a protocol
+         * violation) the client reconnects once before those sequential retries. A device
+         * that keeps answering with unknown IDs, foreign unit IDs or malformed frames
+         * (@c pipeline_violation_threshold batches in a row) is downgraded to window 1
+         * until @c pipeline_reprobe_after_s passes or it reconnects.
+         * @param requests Batch of reads; each entry's @c ok flag reports its outcome.
+         * @return True when every request in the batch succeeded.
+         */
+        bool read_input_registers_pipelined(std::span<ModbusReadRequest> requests);
+        /**
+         * @brief Same as @ref read_input_registers_pipelined, honoring each request's
+         *        @c function, so input and holding ranges can share one batch.
+         */
+        bool read_registers_pipelined(std::span<ModbusReadRequest> requests);
 
         /**
          * @brief Reads the canonical BMS block (registers 3..37) in one transaction.
@@ -94,22 +293,120 @@ namespace bms
          */
         bool read_bms_block(std::array<std::uint16_t, kRegisterBlockCount> &out_regs);
 
-        /** @brief Updates response timeout (applied immediately when connected). */
+        /**
+         * @brief Reads the whole block described by a register map (see register_map.hpp).
+         * @tparam Map Map type providing kFunction, kStartAddress and kRegisterCount.
+         */
+        template <typename Map>
+        bool read_register_map(std::array<std::uint16_t, Map::kRegisterCount> &out_regs)
+        {
+            if constexpr (Map::kFunction == kFcReadHoldingRegisters)
+            {
+                return read_holding_registers(Map::kStartAddress, static_cast<int>(Map::kRegisterCount), out_regs.data());
+            }
+            else
+            {
+                return read_input_registers(Map::kStartAddress, static_cast<int>(Map::kRegisterCount), out_regs.data());
+            }
+        }
+
+        /**
+         * @brief Updates response timeout (applied immediately when connected).
+         * @note With @c adaptive_timeout enabled this is the initial/fallback value.
+         */
         void set_response_timeout(std::chrono::milliseconds timeout);
         /** @brief Updates inter-byte timeout (applied immediately when connected). */
         void set_byte_timeout(std::chrono::milliseconds timeout);
 
         const ModbusTcpConfig &config() const noexcept { return cfg_; }
         const ModbusStatus &status() const noexcept { return status_; }
+        CircuitState circuit_state() const noexcept { return status_.circuit_state; }
+        /** @brief Shared connection in use, or nullptr when the client owns its socket. */
+        const ModbusGateway *gateway() const noexcept { return gateway_.get(); }
+        /** @brief True when the last read was rejected without touching the network. */
+        bool last_read_skipped() const noexcept { return last_read_skipped_; }
+        /** @brief Timing of the last successful single read or write. */
+        const ModbusExchangeTimes &last_exchange() const noexcept { return last_exchange_; }
+        const LatencyHistogram &rtt_histogram() const noexcept { return rtt_histogram_; }
 
     private:
+        /**
+         * @brief Borrows the gateway link for one operation; no-op for private connections.
+         * @details Re-entrant: only the outermost lease locks and syncs the link.
+         */
+        class LinkLease final
+        {
+        public:
+            explicit LinkLease(ModbusTcpClient &client);
+            ~LinkLease();
+
+            LinkLease(const LinkLease &) = delete;
+            LinkLease &operator=(const LinkLease &) = delete;
+
+        private:
+            ModbusTcpClient &client_;
+            std::unique_lock<std::mutex> lock_;
+            bool outer_{false};
+        };
+
+        void attach_link_();
+        void detach_link_();
+        bool connect_shared_();
+        bool relink_gateway_(int &error_out);
+        void apply_timeouts_();
+
+        bool read_registers_(std::uint8_t function, int addr, int count, std::uint16_t *dest);
+        int read_framed_(std::uint8_t function, int addr, int count, std::uint16_t *dest);
+        void *open_context_(int attempts, int &error_out) const;
+        bool admit_request_();
+        void on_read_outcome_(bool ok);
+        void open_circuit_();
+        void adopt_background_context_();
+        void reconnect_loop_();
+        std::chrono::milliseconds next_backoff_();
         bool ensure_connected_();
         void update_error_(const char *prefix);
+        bool read_sequential_(std::span<ModbusReadRequest> requests);
+        void on_pipeline_violation_(const char *reason);
+        void resync_link_();
+        void reprobe_pipeline_window_();
+        void record_rtt_(std::chrono::steady_clock::duration rtt);
+        void retune_timeout_();
+        void apply_response_timeout_();
 
         ModbusTcpConfig cfg_;
         ModbusStatus status_;
-        void *ctx_{nullptr}; // Opaque modbus_t*
+        std::shared_ptr<ModbusGateway> gateway_;
+        int lease_depth_{0};
+        void *ctx_{nullptr}; // Opaque modbus_t*; mirrors the gateway's link while leased
         bool connected_{false};
+        std::uint16_t next_transaction_id_{0x8000}; // Separate range from libmodbus' counter
+
+        int consecutive_pipeline_violations_{0};
+        std::chrono::steady_clock::time_point pipeline_reprobe_at_{};
+        std::uint64_t pipeline_fallback_reconnects_{0}; // status_.reconnects that ends the fallback
+        std::vector<std::chrono::steady_clock::time_point> pipeline_sent_at_; // Per batch entry
+
+        LatencyHistogram rtt_histogram_;
+        std::uint32_t rtt_samples_since_retune_{0};
+        std::uint32_t rtt_samples_since_decay_{0};
+
+        int consecutive_failures_{0};
+        bool last_read_skipped_{false};
+        ModbusExchangeTimes last_exchange_{};
+
+        // Background reconnect state shared with reconnect_thread_.
+        boost::atomic<void *> ready_ctx_{nullptr}; // Connected modbus_t* awaiting adoption
+        boost::atomic<bool> link_ready_{false};    // Shared link re-established by the reconnect thread
+        boost::atomic<std::uint64_t> bg_attempts_{0};
+        boost::atomic<int> bg_last_errno_{0};
+        std::mutex bg_mutex_;
+        std::condition_variable bg_cv_;
+        bool bg_wanted_{false};
+        bool bg_stop_{false};
+        std::chrono::milliseconds bg_backoff_{0};
+        std::minstd_rand bg_rng_;
+        boost::thread reconnect_thread_;
     };
 
 } // namespace bms
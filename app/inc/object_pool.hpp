@@ -0,0 +1,198 @@
+/**
+ * @file object_pool.hpp
+ * @brief Lock-free fixed-capacity object pool and the matching @ref SafeQueue disposer.
+ */
+
+#pragma once
+
+#include <boost/assert.hpp>
+#include <boost/atomic.hpp>
+#include <boost/lockfree/stack.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace bms
+{
+    /**
+     * @brief Lock-free counters exported for pool diagnostics.
+     */
+    struct ObjectPoolStats final
+    {
+        std::uint64_t acquired{0};
+        std::uint64_t released{0};
+        std::uint64_t exhausted{0}; // acquire() calls that found no free slot
+        std::uint64_t in_use{0};
+        std::uint64_t peak_in_use{0};
+    };
+
+    /**
+     * @brief Fixed set of preallocated slots handed out as @c T pointers.
+     * @tparam T Object type constructed in place on acquire and destroyed on release.
+     * @details Slot storage and the free-list nodes are allocated once in the constructor;
+     * @ref acquire and @ref release never touch the heap. An empty pool fails fast
+     * (nullptr, counted as exhausted) instead of falling back to @c new, so an
+     * undersized pool shows up in diagnostics rather than as allocation jitter.
+     * Any thread may acquire or release.
+     */
+    template <typename T>
+    class ObjectPool final
+    {
+    public:
+        using value_type = T;
+        using pointer = T *;
+
+        explicit ObjectPool(std::size_t capacity)
+            : slots_(new Slot[capacity]),
+              free_(capacity),
+              capacity_(capacity)
+        {
+            for (std::size_t i = 0; i < capacity_; ++i)
+            {
+                free_.bounded_push(slot_ptr_(i));
+            }
+        }
+
+        ObjectPool(const ObjectPool &) = delete;
+        ObjectPool &operator=(const ObjectPool &) = delete;
+
+        /**
+         * @brief Takes a free slot and constructs a @c T in it from @p args.
+         * @return The object, or nullptr when every slot is in use.
+         */
+        template <typename... Args>
+        pointer acquire(Args &&...args) noexcept
+        {
+            pointer slot = nullptr;
+            if (!free_.pop(slot))
+            {
+                exhausted_.fetch_add(1, boost::memory_order_relaxed);
+                return nullptr;
+            }
+
+            pointer p = ::new (static_cast<void *>(slot)) T(std::forward<Args>(args)...);
+            const std::uint64_t acquired_now = acquired_.fetch_add(1, boost::memory_order_relaxed) + 1;
+            const std::uint64_t released_now = released_.load(boost::memory_order_relaxed);
+            update_peak_in_use_(acquired_now > released_now ? acquired_now - released_now : 0);
+            return p;
+        }
+
+        /**
+         * @brief Destroys @p p and returns its slot to the pool.
+         * @pre @p p came from @ref acquire on this pool and was not released since.
+         */
+        void release(pointer p) noexcept
+        {
+            if (p == nullptr)
+            {
+                return;
+            }
+            BOOST_ASSERT(owns(p));
+
+            p->~T();
+            released_.fetch_add(1, boost::memory_order_relaxed);
+            // Cannot fail: at most capacity_ slots exist and their nodes were reserved up front.
+            free_.bounded_push(p);
+        }
+
+        bool owns(const T *p) const noexcept
+        {
+            const auto *first = reinterpret_cast<const unsigned char *>(slots_.get());
+            const auto *last = first + capacity_ * sizeof(Slot);
+            const auto *q = reinterpret_cast<const unsigned char *>(p);
+            return q >= first && q < last &&
+                   static_cast<std::size_t>(q - first) % sizeof(Slot) == 0;
+        }
+
+        /**
+         * @brief Slot index of @p p in [0, capacity), stable for the pool's lifetime.
+         * @pre @ref owns(p).
+         */
+        std::size_t index_of(const T *p) const noexcept
+        {
+            BOOST_ASSERT(owns(p));
+            return static_cast<std::size_t>(reinterpret_cast<const unsigned char *>(p) -
+                                            reinterpret_cast<const unsigned char *>(slots_.get())) /
+                   sizeof(Slot);
+        }
+
+        std::size_t capacity() const noexcept
+        {
+            return capacity_;
+        }
+
+        std::uint64_t in_use() const noexcept
+        {
+            const auto a = acquired_.load(boost::memory_order_relaxed);
+            const auto r = released_.load(boost::memory_order_relaxed);
+            return (a > r) ? (a - r) : 0;
+        }
+
+        std::uint64_t exhausted_count() const noexcept
+        {
+            return exhausted_.load(boost::memory_order_relaxed);
+        }
+
+        ObjectPoolStats stats() const noexcept
+        {
+            ObjectPoolStats s;
+            s.acquired = acquired_.load(boost::memory_order_relaxed);
+            s.released = released_.load(boost::memory_order_relaxed);
+            s.exhausted = exhausted_.load(boost::memory_order_relaxed);
+            s.in_use = (s.acquired > s.released) ? (s.acquired - s.released) : 0;
+            s.peak_in_use = peak_in_use_.load(boost::memory_order_relaxed);
+            return s;
+        }
+
+    private:
+        struct Slot
+        {
+            alignas(T) unsigned char bytes[sizeof(T)];
+        };
+
+        pointer slot_ptr_(std::size_t i) noexcept
+        {
+            return reinterpret_cast<pointer>(slots_[i].bytes);
+        }
+
+        void update_peak_in_use_(std::uint64_t candidate) noexcept
+        {
+            std::uint64_t current_peak = peak_in_use_.load(boost::memory_order_relaxed);
+            while (candidate > current_peak &&
+                   !peak_in_use_.compare_exchange_weak(
+                       current_peak,
+                       candidate,
+                       boost::memory_order_relaxed,
+                       boost::memory_order_relaxed))
+            {
+            }
+        }
+
+        std::unique_ptr<Slot[]> slots_;
+        boost::lockfree::stack<pointer> free_;
+        std::size_t capacity_;
+
+        boost::atomic<std::uint64_t> acquired_{0};
+        boost::atomic<std::uint64_t> released_{0};
+        boost::atomic<std::uint64_t> exhausted_{0};
+        boost::atomic<std::uint64_t> peak_in_use_{0};
+    };
+
+    /**
+     * @brief @ref SafeQueue disposer that returns pointers to an @ref ObjectPool.
+     * @details Several queues may share one pool; the pool must outlive them all.
+     */
+    template <typename T>
+    struct pool_disposer
+    {
+        explicit pool_disposer(ObjectPool<T> &pool) noexcept : pool(&pool) {}
+
+        void operator()(T *p) const noexcept { pool->release(p); }
+
+        ObjectPool<T> *pool;
+    };
+
+} // namespace bms
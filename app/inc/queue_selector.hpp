@@ -0,0 +1,103 @@
+/**
+ * @file queue_selector.hpp
+ * @brief Blocking wait on several queues at once, returning the one that became ready.
+ */
+
+#pragma once
+
+#include "event_count.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace bms
+{
+    /**
+     * @brief Lets one consumer thread sleep until any of its @ref SafeQueue or
+     * @ref SafeValueQueue inputs has data, instead of blocking on one and polling the rest.
+     * @details Every added queue notifies a shared eventcount "doorbell" on push and on
+     * close, in addition to its own waiters. While nobody waits that costs a fence and a
+     * load; a sleeping selector is woken by the first push on any of its queues.
+     *
+     * Add every queue before its producer starts. A queue feeds at most one selector, and
+     * the selector must not be destroyed while producers may still push to its queues.
+     * Not thread-safe: one consumer thread owns the selector.
+     */
+    class QueueSelector final
+    {
+    public:
+        QueueSelector() = default;
+        QueueSelector(const QueueSelector &) = delete;
+        QueueSelector &operator=(const QueueSelector &) = delete;
+
+        /** @brief Detaches from every queue. */
+        ~QueueSelector();
+
+        /**
+         * @brief Watches @p queue.
+         * @return Index that @ref wait reports when @p queue is ready.
+         */
+        template <typename Queue>
+        std::size_t add(Queue &queue)
+        {
+            queue.attach_doorbell(&doorbell_);
+            sources_.push_back(Source{
+                &queue,
+                [](const void *q) { return static_cast<const Queue *>(q)->approximate_size() > 0; },
+                [](const void *q) { return static_cast<const Queue *>(q)->is_closed(); },
+                [](void *q) { static_cast<Queue *>(q)->attach_doorbell(nullptr); }});
+            return sources_.size() - 1;
+        }
+
+        /**
+         * @brief Index of a queue holding data, without blocking.
+         * @details Scanning starts after the last queue reported, so a busy queue cannot
+         * starve the others.
+         */
+        std::optional<std::size_t> poll() noexcept;
+
+        /**
+         * @brief Blocks until a queue holds data and returns its index.
+         * @return std::nullopt once every queue is closed and empty.
+         */
+        std::optional<std::size_t> wait() noexcept;
+
+        /**
+         * @brief Like @ref wait, giving up at @p deadline.
+         * @return std::nullopt on timeout, or once every queue is closed and empty;
+         * @ref all_closed tells the two apart.
+         */
+        std::optional<std::size_t> wait_until(std::chrono::steady_clock::time_point deadline) noexcept;
+
+        template <typename Rep, typename Period>
+        std::optional<std::size_t> wait_for(const std::chrono::duration<Rep, Period> &timeout) noexcept
+        {
+            return wait_until(std::chrono::steady_clock::now() + timeout);
+        }
+
+        /** @brief True when every queue is closed and fully drained. */
+        bool all_closed() const noexcept;
+
+        std::size_t size() const noexcept
+        {
+            return sources_.size();
+        }
+
+    private:
+        // Type-erased view of one queue.
+        struct Source final
+        {
+            void *queue;
+            bool (*ready)(const void *);
+            bool (*closed)(const void *);
+            void (*detach)(void *);
+        };
+
+        EventCount doorbell_;
+        std::vector<Source> sources_;
+        std::size_t next_{0};
+    };
+
+} // namespace bms
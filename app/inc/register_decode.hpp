@@ -0,0 +1,79 @@
+/**
+ * @file register_decode.hpp
+ * @brief Vectorized decode of big-endian word-pair MODBUS floats with fused validation.
+ */
+
+#pragma once
+
+#include "batch_structures.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace bms
+{
+    /** @brief Largest float run a single decode call may cover (one mask bit per value). */
+    inline constexpr std::size_t kMaxDecodeFloats = 32;
+
+    /**
+     * @brief Validation and clamping applied while decoding.
+     * @note Values outside [min, max] are flagged; with @ref clamp they are also clamped,
+     *       and non-finite values are replaced by @ref min.
+     */
+    struct FloatDecodeOptions final
+    {
+        float min{-std::numeric_limits<float>::infinity()};
+        float max{std::numeric_limits<float>::infinity()};
+        bool clamp{false};
+    };
+
+    /**
+     * @brief Per-value anomaly bitmasks (bit i refers to output value i).
+     */
+    struct FloatDecodeReport final
+    {
+        std::uint32_t non_finite_mask{0};   // Decoded NaN/Inf (before clamping)
+        std::uint32_t out_of_range_mask{0}; // Finite but outside [min, max]
+
+        /** @brief Maps the anomalies of the values selected by @p mask to sample flags. */
+        SampleFlags flags(std::uint32_t mask = ~0u) const noexcept
+        {
+            SampleFlags out = SampleFlags::None;
+            if ((non_finite_mask & mask) != 0u)
+            {
+                out = out | SampleFlags::DecodeError;
+            }
+            if ((out_of_range_mask & mask) != 0u)
+            {
+                out = out | SampleFlags::RangeError;
+            }
+            return out;
+        }
+    };
+
+    /**
+     * @brief Decodes @p count floats from 2*@p count register words (high word first).
+     * @details Uses AVX2, SSE2 or NEON when available at compile time, with a scalar
+     * fallback. Word swapping, validation and optional clamping happen in one pass.
+     * @param words First register word of the run; no alignment required.
+     * @param count Number of floats, at most @ref kMaxDecodeFloats.
+     * @param out Destination for @p count floats.
+     */
+    FloatDecodeReport decode_float_words(const std::uint16_t *words,
+                                         std::size_t count,
+                                         float *out,
+                                         const FloatDecodeOptions &opts = FloatDecodeOptions{}) noexcept;
+
+    /**
+     * @brief Portable reference implementation of @ref decode_float_words.
+     */
+    FloatDecodeReport decode_float_words_scalar(const std::uint16_t *words,
+                                                std::size_t count,
+                                                float *out,
+                                                const FloatDecodeOptions &opts = FloatDecodeOptions{}) noexcept;
+
+    /** @brief Name of the kernel selected at compile time ("avx2", "sse2", "neon", "scalar"). */
+    const char *decode_kernel_name() noexcept;
+
+} // namespace bms
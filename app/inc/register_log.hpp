@@ -0,0 +1,152 @@
+/**
+ * @file register_log.hpp
+ * @brief Memory-mapped binary log of raw register blocks (recorder and reader).
+ */
+
+#pragma once
+
+#include "batch_structures.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <string>
+
+namespace bms
+{
+    /**
+     * @brief Which acquisition path a logged block came from.
+     */
+    enum class RecordSource : std::uint8_t
+    {
+        VoltageDevice1 = 1,
+        VoltageDevice2 = 2,
+        Temperature = 3
+    };
+
+    /**
+     * @brief File header; the log is this header followed by fixed-size records.
+     * @note @ref record_count is updated after every append, so a log cut short by a
+     *       crash or power loss stays readable up to the last complete record.
+     */
+    struct RegisterLogHeader final
+    {
+        char magic[8];               // "BMSRLOG1"
+        std::uint32_t version;
+        std::uint32_t record_size;   // sizeof(RegisterLogRecord)
+        std::uint32_t register_count; // kRegisterBlockCount
+        std::uint32_t reserved;
+        std::uint64_t record_count;
+        std::uint8_t padding[32];
+    };
+    static_assert(sizeof(RegisterLogHeader) == 64);
+
+    /**
+     * @brief One logged block read, in host byte order.
+     * @details Failed and skipped reads are logged too (with zeroed registers) so a
+     * replay reproduces partial samples and outages. Device 1 and device 2 blocks of the
+     * same voltage/current cycle share @ref cycle.
+     */
+    struct RegisterLogRecord final
+    {
+        std::int64_t wall_started_ns;  // Host system clock, ns since the Unix epoch
+        std::int64_t wall_finished_ns;
+        std::uint64_t cycle;           // Acquisition sequence number
+        std::uint8_t source;           // RecordSource
+        std::uint8_t ok;
+        std::uint8_t skipped;
+        std::uint8_t reserved[5];
+        std::uint16_t regs[kRegisterBlockCount];
+        std::uint8_t padding[2];
+    };
+    static_assert(sizeof(RegisterLogRecord) == 104);
+
+    /** @brief Packs a block read into a log record. */
+    RegisterLogRecord make_log_record(RecordSource source, std::uint64_t cycle, const TimedBlockRead &read) noexcept;
+
+    /**
+     * @brief Unpacks a log record into a block read.
+     * @details Steady-clock fields are rebuilt from the wall-clock span, which keeps
+     * durations and inter-device skew identical to the recording.
+     */
+    TimedBlockRead to_block_read(const RegisterLogRecord &record) noexcept;
+
+    /**
+     * @brief Appends block reads to a memory-mapped log file.
+     * @details Appends are a bounded memcpy into a shared mapping that grows in
+     * @c grow_bytes steps, so the acquisition threads never issue a write syscall per
+     * record. Safe to share between acquisition threads (appends are serialized).
+     */
+    class RegisterRecorder final
+    {
+    public:
+        explicit RegisterRecorder(std::string path, std::size_t grow_bytes = 4u << 20);
+        ~RegisterRecorder();
+
+        RegisterRecorder(const RegisterRecorder &) = delete;
+        RegisterRecorder &operator=(const RegisterRecorder &) = delete;
+
+        /**
+         * @brief Creates (truncates) the log file and maps its first chunk.
+         * @return False on I/O failure; see @ref last_error.
+         */
+        bool open();
+        /** @brief Trims the file to its exact length and unmaps it. */
+        void close();
+
+        /**
+         * @brief Appends one block read.
+         * @return False when the recorder is closed or the file could not be grown.
+         */
+        bool append(RecordSource source, std::uint64_t cycle, const TimedBlockRead &read);
+
+        std::uint64_t records() const noexcept;
+        const std::string &path() const noexcept { return path_; }
+        const std::string &last_error() const noexcept { return last_error_; }
+
+    private:
+        bool map_(std::size_t size);
+        void unmap_() noexcept;
+
+        std::string path_;
+        std::size_t grow_bytes_;
+        mutable std::mutex mutex_;
+        int fd_{-1};
+        std::uint8_t *base_{nullptr};
+        std::size_t mapped_{0};
+        std::uint64_t count_{0};
+        std::string last_error_;
+    };
+
+    /**
+     * @brief Read-only memory-mapped view of a register log.
+     */
+    class RegisterLogReader final
+    {
+    public:
+        RegisterLogReader() = default;
+        ~RegisterLogReader();
+
+        RegisterLogReader(const RegisterLogReader &) = delete;
+        RegisterLogReader &operator=(const RegisterLogReader &) = delete;
+
+        /**
+         * @brief Maps @p path and validates its header.
+         * @return False when the file is missing, truncated, or not a register log.
+         */
+        bool open(const std::string &path);
+        void close() noexcept;
+
+        /** @brief All complete records, in recording order. */
+        std::span<const RegisterLogRecord> records() const noexcept;
+        const std::string &last_error() const noexcept { return last_error_; }
+
+    private:
+        const std::uint8_t *base_{nullptr};
+        std::size_t size_{0};
+        std::size_t count_{0};
+        std::string last_error_;
+    };
+
+} // namespace bms
@@ -0,0 +1,326 @@
+/**
+ * @file register_map.hpp
+ * @brief Declarative MODBUS register maps and compile-time specialized decoders.
+ */
+
+#pragma once
+
+#include "batch_structures.hpp"
+#include "modbus_frame.hpp"
+#include "register_decode.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace bms
+{
+
+    // ============================================================================
+    // Field Description
+    // ============================================================================
+
+    /** @brief Wire type of one mapped field. */
+    enum class RegisterType : std::uint8_t
+    {
+        UInt16,
+        Int16,
+        UInt32,
+        Int32,
+        Float32
+    };
+
+    /** @brief Order of the two registers holding a 32-bit field. */
+    enum class WordOrder : std::uint8_t
+    {
+        HighFirst, // Device default: high word at the lower address
+        LowFirst
+    };
+
+    /**
+     * @brief One named value inside a register block.
+     * @note @ref offset is relative to the map's start address. Decoded value is
+     *       raw * @ref scale, always delivered as float.
+     */
+    struct RegisterField final
+    {
+        std::string_view name;
+        std::uint16_t offset{0};
+        RegisterType type{RegisterType::UInt16};
+        WordOrder order{WordOrder::HighFirst};
+        float scale{1.0F};
+    };
+
+    inline constexpr std::size_t register_width(RegisterType type) noexcept
+    {
+        return (type == RegisterType::UInt16 || type == RegisterType::Int16) ? 1u : 2u;
+    }
+
+    /** @brief Float32 channel @p channel of the canonical 35-register acquisition block. */
+    inline constexpr RegisterField float_channel(std::string_view name, std::uint16_t channel) noexcept
+    {
+        return RegisterField{name, static_cast<std::uint16_t>(3 + 2 * channel), RegisterType::Float32};
+    }
+
+    // ============================================================================
+    // Register Maps
+    // ============================================================================
+    //
+    // A map is a type exposing kFunction, kStartAddress, kRegisterCount and a constexpr
+    // kFields array. decode_register_map<Map>() is instantiated per map, so field types,
+    // offsets and scales are compile-time constants in the generated code.
+
+    /** @brief Voltage board A (device 1): channels 0..7 -> cells 1..8. */
+    struct VoltageBoardAMap final
+    {
+        static constexpr std::uint8_t kFunction = kFcReadInputRegisters;
+        static constexpr int kStartAddress = kModbusStartAddr;
+        static constexpr std::size_t kRegisterCount = kRegisterBlockCount;
+        static constexpr std::array<RegisterField, 8> kFields{{
+            float_channel("cell1_v", 0),
+            float_channel("cell2_v", 1),
+            float_channel("cell3_v", 2),
+            float_channel("cell4_v", 3),
+            float_channel("cell5_v", 4),
+            float_channel("cell6_v", 5),
+            float_channel("cell7_v", 6),
+            float_channel("cell8_v", 7),
+        }};
+        static constexpr std::size_t kCellCount = 8;
+    };
+
+    /** @brief Voltage board B (device 2): channels 0..6 -> cells 9..15, channel 7 -> current sensor. */
+    struct VoltageBoardBMap final
+    {
+        static constexpr std::uint8_t kFunction = kFcReadInputRegisters;
+        static constexpr int kStartAddress = kModbusStartAddr;
+        static constexpr std::size_t kRegisterCount = kRegisterBlockCount;
+        static constexpr std::array<RegisterField, 8> kFields{{
+            float_channel("cell9_v", 0),
+            float_channel("cell10_v", 1),
+            float_channel("cell11_v", 2),
+            float_channel("cell12_v", 3),
+            float_channel("cell13_v", 4),
+            float_channel("cell14_v", 5),
+            float_channel("cell15_v", 6),
+            float_channel("current_sensor_v", 7),
+        }};
+        static constexpr std::size_t kCellCount = 7;
+    };
+
+    /** @brief 16-channel temperature board. */
+    struct TemperatureBoardMap final
+    {
+        static constexpr std::uint8_t kFunction = kFcReadInputRegisters;
+        static constexpr int kStartAddress = kModbusStartAddr;
+        static constexpr std::size_t kRegisterCount = kRegisterBlockCount;
+        static constexpr std::array<RegisterField, 16> kFields{{
+            float_channel("sensor1_c", 0),
+            float_channel("sensor2_c", 1),
+            float_channel("sensor3_c", 2),
+            float_channel("sensor4_c", 3),
+            float_channel("sensor5_c", 4),
+            float_channel("sensor6_c", 5),
+            float_channel("sensor7_c", 6),
+            float_channel("sensor8_c", 7),
+            float_channel("sensor9_c", 8),
+            float_channel("sensor10_c", 9),
+            float_channel("sensor11_c", 10),
+            float_channel("sensor12_c", 11),
+            float_channel("sensor13_c", 12),
+            float_channel("sensor14_c", 13),
+            float_channel("sensor15_c", 14),
+            float_channel("sensor16_c", 15),
+        }};
+    };
+
+    /**
+     * @brief UNIPOWER UPLFP48 pack, holding registers 0..37 (see scripts/read_uplfp48_modbus.py).
+     * @note Current scale follows the 10 mA/LSB reading; the vendor manual is inconsistent.
+     */
+    struct Uplfp48Map final
+    {
+        static constexpr std::uint8_t kFunction = kFcReadHoldingRegisters;
+        static constexpr int kStartAddress = 0;
+        static constexpr std::size_t kRegisterCount = 38;
+        static constexpr std::array<RegisterField, 36> kFields{{
+            {"pack_voltage_v", 0, RegisterType::UInt16, WordOrder::HighFirst, 0.01F},
+            {"current_a", 1, RegisterType::Int16, WordOrder::HighFirst, 0.01F},
+            {"cell1_v", 2, RegisterType::UInt16, WordOrder::HighFirst, 0.001F},
+            {"cell2_v", 3, RegisterType::UInt16, WordOrder::HighFirst, 0.001F},
+            {"cell3_v", 4, RegisterType::UInt16, WordOrder::HighFirst, 0.001F},
+            {"cell4_v", 5, RegisterType::UInt16, WordOrder::HighFirst, 0.001F},
+            {"cell5_v", 6, RegisterType::UInt16, WordOrder::HighFirst, 0.001F},
+            {"cell6_v", 7, RegisterType::UInt16, WordOrder::HighFirst, 0.001F},
+            {"cell7_v", 8, RegisterType::UInt16, WordOrder::HighFirst, 0.001F},
+            {"cell8_v", 9, RegisterType::UInt16, WordOrder::HighFirst, 0.001F},
+            {"cell9_v", 10, RegisterType::UInt16, WordOrder::HighFirst, 0.001F},
+            {"cell10_v", 11, RegisterType::UInt16, WordOrder::HighFirst, 0.001F},
+            {"cell11_v", 12, RegisterType::UInt16, WordOrder::HighFirst, 0.001F},
+            {"cell12_v", 13, RegisterType::UInt16, WordOrder::HighFirst, 0.001F},
+            {"cell13_v", 14, RegisterType::UInt16, WordOrder::HighFirst, 0.001F},
+            {"cell14_v", 15, RegisterType::UInt16, WordOrder::HighFirst, 0.001F},
+            {"cell15_v", 16, RegisterType::UInt16, WordOrder::HighFirst, 0.001F},
+            {"cell16_v", 17, RegisterType::UInt16, WordOrder::HighFirst, 0.001F},
+            {"bms_temperature_c", 18, RegisterType::Int16},
+            {"internal_temperature_c", 19, RegisterType::Int16},
+            {"max_cell_temperature_c", 20, RegisterType::Int16},
+            {"remaining_capacity_ah", 21, RegisterType::UInt16},
+            {"max_charge_current_a", 22, RegisterType::UInt16},
+            {"soh_pct", 23, RegisterType::UInt16},
+            {"soc_pct", 24, RegisterType::UInt16},
+            {"status", 25, RegisterType::UInt16},
+            {"alarm", 26, RegisterType::UInt16},
+            {"protection", 27, RegisterType::UInt16},
+            {"error_code", 28, RegisterType::UInt16},
+            {"cycle_count", 29, RegisterType::UInt32},
+            {"full_charge_capacity_ah", 31, RegisterType::UInt32, WordOrder::HighFirst, 1.0F / 3600000.0F}, // mAs
+            {"cell_temperature1_c", 33, RegisterType::UInt16},
+            {"cell_temperature2_c", 34, RegisterType::UInt16},
+            {"cell_temperature3_c", 35, RegisterType::UInt16},
+            {"cell_count", 36, RegisterType::UInt16},
+            {"design_capacity_ah", 37, RegisterType::UInt16, WordOrder::HighFirst, 0.1F},
+        }};
+    };
+
+    /** @brief Decoded values of a map, indexed like @c Map::kFields. */
+    template <typename Map>
+    using RegisterMapValues = std::array<float, std::tuple_size_v<decltype(Map::kFields)>>;
+
+    /** @brief Compile-time index of the field called @p name (size() when absent). */
+    template <typename Map>
+    inline constexpr std::size_t field_index(std::string_view name) noexcept
+    {
+        for (std::size_t i = 0; i < Map::kFields.size(); ++i)
+        {
+            if (Map::kFields[i].name == name)
+            {
+                return i;
+            }
+        }
+        return Map::kFields.size();
+    }
+
+    // ============================================================================
+    // Specialized Decoders
+    // ============================================================================
+
+    namespace detail
+    {
+        template <typename Map>
+        inline constexpr bool register_map_fits() noexcept
+        {
+            for (const auto &field : Map::kFields)
+            {
+                if (field.offset + register_width(field.type) > Map::kRegisterCount)
+                {
+                    return false;
+                }
+            }
+            return Map::kRegisterCount <= kMaxReadRegisters;
+        }
+
+        inline constexpr bool is_vector_float(const RegisterField &field) noexcept
+        {
+            return field.type == RegisterType::Float32 &&
+                   field.order == WordOrder::HighFirst &&
+                   field.scale == 1.0F;
+        }
+
+        /** @brief Length of the run of adjacent float fields starting at field @p I. */
+        template <typename Map, std::size_t I>
+        inline constexpr std::size_t float_run_length() noexcept
+        {
+            constexpr auto &fields = Map::kFields;
+            std::size_t n = 0;
+            while (I + n < fields.size() &&
+                   is_vector_float(fields[I + n]) &&
+                   fields[I + n].offset == fields[I].offset + 2 * n)
+            {
+                ++n;
+            }
+            return n;
+        }
+
+        template <RegisterType Type, WordOrder Order>
+        inline double read_raw(const std::uint16_t *regs) noexcept
+        {
+            if constexpr (Type == RegisterType::UInt16)
+            {
+                return regs[0];
+            }
+            else if constexpr (Type == RegisterType::Int16)
+            {
+                return static_cast<std::int16_t>(regs[0]);
+            }
+            else
+            {
+                const std::uint16_t hi = Order == WordOrder::HighFirst ? regs[0] : regs[1];
+                const std::uint16_t lo = Order == WordOrder::HighFirst ? regs[1] : regs[0];
+                const std::uint32_t raw = (static_cast<std::uint32_t>(hi) << 16) | lo;
+                if constexpr (Type == RegisterType::UInt32)
+                {
+                    return raw;
+                }
+                else if constexpr (Type == RegisterType::Int32)
+                {
+                    return static_cast<std::int32_t>(raw);
+                }
+                else
+                {
+                    return modbus_registers_to_float(hi, lo);
+                }
+            }
+        }
+
+        template <typename Map, std::size_t I>
+        inline void decode_fields_from(const std::uint16_t *block,
+                                       float *out,
+                                       const FloatDecodeOptions &opts,
+                                       FloatDecodeReport &report) noexcept
+        {
+            if constexpr (I < Map::kFields.size())
+            {
+                constexpr RegisterField field = Map::kFields[I];
+                constexpr std::size_t run = float_run_length<Map, I>();
+
+                if constexpr (run > 0)
+                {
+                    // Adjacent big-endian floats: one vector decode for the whole run.
+                    static_assert(I + run <= kMaxDecodeFloats, "float fields must be within the first 32");
+                    const FloatDecodeReport part = decode_float_words(block + field.offset, run, out + I, opts);
+                    report.non_finite_mask |= part.non_finite_mask << I;
+                    report.out_of_range_mask |= part.out_of_range_mask << I;
+                    decode_fields_from<Map, I + run>(block, out, opts, report);
+                }
+                else
+                {
+                    const double raw = read_raw<field.type, field.order>(block + field.offset);
+                    out[I] = static_cast<float>(raw * static_cast<double>(field.scale));
+                    decode_fields_from<Map, I + 1>(block, out, opts, report);
+                }
+            }
+        }
+    } // namespace detail
+
+    /**
+     * @brief Decodes every field of @p Map from a register block read at @c Map::kStartAddress.
+     * @details Instantiated per map: integer fields compile to straight-line loads and
+     * scales, adjacent float fields to a single SIMD decode. @p opts (validation and
+     * clamping) applies to float fields; the report masks are indexed by field.
+     */
+    template <typename Map>
+    inline FloatDecodeReport decode_register_map(
+        const std::array<std::uint16_t, Map::kRegisterCount> &regs,
+        RegisterMapValues<Map> &out,
+        const FloatDecodeOptions &opts = FloatDecodeOptions{}) noexcept
+    {
+        static_assert(detail::register_map_fits<Map>(), "register map field exceeds its block");
+
+        FloatDecodeReport report;
+        detail::decode_fields_from<Map, 0>(regs.data(), out.data(), opts, report);
+        return report;
+    }
+
+} // namespace bms
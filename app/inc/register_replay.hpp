@@ -0,0 +1,85 @@
+/**
+ * @file register_replay.hpp
+ * @brief Replays a register log through the acquisition decode/publish path.
+ */
+
+#pragma once
+
+#include "register_log.hpp"
+#include "temperature.hpp"
+#include "voltage_current.hpp"
+
+#include <boost/atomic.hpp>
+
+#include <cstdint>
+#include <string>
+
+namespace bms
+{
+    /**
+     * @brief Replay source and pacing.
+     */
+    struct RegisterReplayConfig final
+    {
+        std::string path;
+        double speed{1.0}; // 1 = recorded cadence, N = N times faster, 0 = unthrottled
+    };
+
+    /**
+     * @brief Lock-free counters exported for replay diagnostics.
+     */
+    struct RegisterReplayDiagnostics final
+    {
+        boost::atomic<std::uint64_t> records{0};
+        boost::atomic<std::uint64_t> voltage_cycles{0};
+        boost::atomic<std::uint64_t> temperature_cycles{0};
+        boost::atomic<std::uint64_t> unpaired_records{0}; // Voltage half without its partner
+        boost::atomic<std::int64_t> elapsed_ms{0};
+        boost::atomic<bool> finished{false};
+    };
+
+    /**
+     * @brief Feeds logged block reads into the acquisitions' @c ingest paths.
+     * @details Device 1/device 2 records of one voltage/current cycle are paired by cycle
+     * number. Records are released at their recorded offsets divided by @c speed, or
+     * back to back when unthrottled; downstream queues then apply backpressure. Samples
+     * keep their recorded timestamps because clock estimation runs on the logged
+     * request times.
+     */
+    class RegisterLogReplay final
+    {
+    public:
+        /**
+         * @param cfg Log path and speed.
+         * @param voltage_current Destination of voltage records (nullptr skips them).
+         * @param temperature Destination of temperature records (nullptr skips them).
+         */
+        RegisterLogReplay(RegisterReplayConfig cfg,
+                          VoltageCurrentAcquisition *voltage_current,
+                          TemperatureAcquisition *temperature);
+
+        /**
+         * @brief Maps the log file.
+         * @return False when the file is not a readable register log; see @ref last_error.
+         */
+        bool open();
+
+        /** @brief Replays the whole log; intended to run on its own thread. */
+        void operator()();
+        /** @brief Requests an early stop; @ref operator()() returns at the next record. */
+        void stop() noexcept { stop_requested_.store(true); }
+
+        std::size_t record_count() const noexcept { return reader_.records().size(); }
+        const RegisterReplayDiagnostics &diagnostics() const noexcept { return diagnostics_; }
+        const std::string &last_error() const noexcept { return reader_.last_error(); }
+
+    private:
+        RegisterReplayConfig cfg_;
+        VoltageCurrentAcquisition *voltage_current_;
+        TemperatureAcquisition *temperature_;
+        RegisterLogReader reader_;
+        RegisterReplayDiagnostics diagnostics_{};
+        boost::atomic<bool> stop_requested_{false};
+    };
+
+} // namespace bms
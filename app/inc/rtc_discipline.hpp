@@ -0,0 +1,84 @@
+/**
+ * @file rtc_discipline.hpp
+ * @brief Runtime correction of device real-time clocks over MODBUS register writes.
+ */
+
+#pragma once
+
+#include "clock_sync.hpp"
+#include "modbus_reader.hpp"
+
+#include <chrono>
+#include <cstdint>
+
+namespace bms
+{
+    /**
+     * @brief Settings for @ref RtcDiscipline (register layout follows utils/rtc_sync.py).
+     */
+    struct RtcDisciplineConfig final
+    {
+        bool enabled{true};
+        int epoch_register{290};          // Holding registers: epoch2000 seconds (hi, lo)
+        bool write_milliseconds{false};   // Device also accepts ms in the next register
+        std::int64_t threshold_ms{500};   // Correct when |device - host| exceeds this
+        std::int64_t max_uncertainty_ms{50}; // Only act on a trustworthy estimate
+        std::int64_t min_interval_s{600}; // Between write attempts, successful or not
+        std::int64_t phase_window_ms{50}; // Seconds-only writes wait for a second boundary...
+        std::int64_t max_phase_wait_s{5}; // ...for at most this long, then round instead
+    };
+
+    /**
+     * @brief Counters for RTC corrections of one device.
+     */
+    struct RtcDisciplineStatus final
+    {
+        std::uint64_t corrections{0};
+        std::uint64_t write_failures{0};
+        std::int64_t last_corrected_offset_us{0}; // Offset that triggered the last write
+    };
+
+    /**
+     * @brief Keeps one device RTC within @c threshold_ms of the host clock.
+     * @details Runs on the acquisition thread after a cycle has published its sample, so a
+     * correction costs one extra request at most every @c min_interval_s. The offset comes
+     * from the device's @ref ClockOffsetEstimator, which already compensates for the
+     * round-trip time of normal polling. The written value is the host time at which the
+     * request is expected to reach the device (now + half the median RTT). Without a ms
+     * register the device can only be set to whole seconds, so the write is held back
+     * until that arrival time falls just after a second boundary (checked once per cycle,
+     * never by sleeping). A successful write steps the device clock, so the estimator is
+     * reset and the next correction waits for a fresh valid estimate.
+     * @note Not thread-safe; use from the thread that owns the client.
+     */
+    class RtcDiscipline final
+    {
+    public:
+        using clock = std::chrono::system_clock;
+
+        explicit RtcDiscipline(RtcDisciplineConfig cfg = RtcDisciplineConfig{}) noexcept;
+
+        /**
+         * @brief Writes the device clock when the estimated offset exceeds the threshold.
+         * @param device Client of the device; must not be in use by another thread.
+         * @param estimator Clock estimator fed by the same device's reads.
+         * @return True when a correction was written during this call.
+         */
+        bool maybe_correct(ModbusTcpClient &device, ClockOffsetEstimator &estimator);
+
+        const RtcDisciplineConfig &config() const noexcept { return cfg_; }
+        const RtcDisciplineStatus &status() const noexcept { return status_; }
+
+    private:
+        bool due_(const ClockOffsetEstimator &estimator, clock::time_point now);
+        bool write_time_(ModbusTcpClient &device, clock::time_point arrival, bool round_to_nearest);
+
+        RtcDisciplineConfig cfg_;
+        RtcDisciplineStatus status_{};
+        std::chrono::steady_clock::time_point last_attempt_{};
+        bool attempted_{false};
+        std::chrono::steady_clock::time_point armed_since_{};
+        bool armed_{false};
+    };
+
+} // namespace bms
@@ -1,18 +1,27 @@
 /**
  * @file safe_queue.hpp
- * @brief Lock-free pointer queue with close-aware blocking and ownership transfer semantics.
+ * @brief Lock-free pointer and value queues with close-aware blocking and ownership transfer semantics.
  */
 
 #pragma once
 
+#include "event_count.hpp"
+#include "latency_histogram.hpp"
+
+#include <boost/align/aligned_allocator.hpp>
 #include <boost/atomic.hpp>
+#include <boost/lockfree/policies.hpp>
 #include <boost/lockfree/queue.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
 
+#include <algorithm>
 #include <chrono>
-#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
-#include <mutex>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <stdexcept>
 #include <type_traits>
 #include <utility>
 
@@ -21,7 +30,7 @@ namespace bms
 
     /**
      * @brief Default pointer disposer used by @ref SafeQueue.
-     * @note Replace with a custom policy for pooled allocation strategies.
+     * @note Use @ref pool_disposer (object_pool.hpp) for pooled allocation.
      */
     template <typename T>
     struct default_disposer
@@ -30,51 +39,638 @@ namespace bms
     };
 
     /**
-     * @brief MPSC lock-free queue for pointer payloads with shutdown-aware waits.
+     * @brief Topology tag: any number of producer and consumer threads (default).
+     */
+    struct mpmc_topology
+    {
+    };
+
+    /**
+     * @brief Topology tag: exactly one producer thread and one consumer thread.
+     * @details Backed by a wait-free @c boost::lockfree::spsc_queue ring whose read and
+     * write indices sit on separate cache lines. Each counter has a single writer, so
+     * updates are plain loads and stores instead of atomic read-modify-writes.
+     */
+    struct spsc_topology
+    {
+    };
+
+    /**
+     * @brief What @c offer does when the queue is full. Each policy has its own counter.
+     */
+    enum class OverflowPolicy : std::uint8_t
+    {
+        Block,          // Wait for space (blocked_count); the producer runs at the consumer's pace
+        DropNewest,     // Reject the new element (dropped_count)
+        DropOldest,     // Evict the oldest queued element (overwritten_count); MPMC topology only
+        CoalesceLatest  // Park the new element in a single latest slot, replacing an unread one
+                        // (coalesced_count); the consumer takes it after the queued backlog.
+                        // SafeValueQueue supports it with the SPSC topology only.
+    };
+
+    namespace detail
+    {
+        /**
+         * @brief Element-independent queue state: close flag, counters and blocking waits.
+         * @details Derived queues own the lock-free storage and pass their non-blocking
+         * enqueue/dequeue attempts to the blocking helpers. @c Derived provides
+         * @c latest_pending_(), true while a coalesced element waits in its latest slot.
+         */
+        template <typename Derived, typename Topology>
+        class queue_core
+        {
+        protected:
+            static constexpr bool kSingleProducerConsumer = std::is_same<Topology, spsc_topology>::value;
+
+        public:
+            using topology_type = Topology;
+
+            queue_core(const queue_core &) = delete;
+            queue_core &operator=(const queue_core &) = delete;
+
+            void close() noexcept
+            {
+                closed_.store(true, boost::memory_order_release);
+                not_empty_.notify_all();
+                not_full_.notify_all();
+                ring_doorbell_();
+            }
+
+            /**
+             * @brief Also notifies @p doorbell whenever this queue may have become non-empty
+             * or closed, so one thread can wait on several queues (see @ref QueueSelector).
+             * @details Attach before the producer starts; nullptr detaches.
+             */
+            void attach_doorbell(EventCount *doorbell) noexcept
+            {
+                doorbell_.store(doorbell, boost::memory_order_release);
+            }
+
+            bool is_closed() const noexcept
+            {
+                return closed_.load(boost::memory_order_acquire);
+            }
+
+            std::uint64_t dropped_count() const noexcept
+            {
+                return dropped_.load(boost::memory_order_relaxed);
+            }
+
+            std::uint64_t total_pushed() const noexcept
+            {
+                return pushed_.load(boost::memory_order_relaxed);
+            }
+
+            std::uint64_t total_popped() const noexcept
+            {
+                return popped_.load(boost::memory_order_relaxed);
+            }
+
+            /** @brief Pushes that found the queue full and had to wait (@ref OverflowPolicy::Block). */
+            std::uint64_t blocked_count() const noexcept
+            {
+                return blocked_.load(boost::memory_order_relaxed);
+            }
+
+            /** @brief Queued elements evicted by newer ones (@ref OverflowPolicy::DropOldest). */
+            std::uint64_t overwritten_count() const noexcept
+            {
+                return overwritten_.load(boost::memory_order_relaxed);
+            }
+
+            /** @brief Latest-slot elements replaced before being read (@ref OverflowPolicy::CoalesceLatest). */
+            std::uint64_t coalesced_count() const noexcept
+            {
+                return coalesced_.load(boost::memory_order_relaxed);
+            }
+
+            /** @brief Queued elements, counting a pending latest slot as one. */
+            std::uint64_t approximate_size() const noexcept
+            {
+                return ring_size_() + (static_cast<const Derived *>(this)->latest_pending_() ? 1 : 0);
+            }
+
+            OverflowPolicy overflow_policy() const noexcept
+            {
+                return policy_;
+            }
+
+            /**
+             * @brief Starts timing how long each element waits in the ring, from push to pop.
+             * @details Stamps every enqueued element with a steady-clock time and records the
+             * wait on dequeue in a per-queue @ref LatencyHistogram. Elements taken from the
+             * CoalesceLatest slot are not timed. Call before producer and consumer start.
+             * @throws std::invalid_argument for @ref mpmc_topology, whose ring order does not
+             * match push order.
+             */
+            void enable_residency_tracking()
+            {
+                if constexpr (!kSingleProducerConsumer)
+                {
+                    throw std::invalid_argument("queue residency tracking requires spsc_topology");
+                }
+                else
+                {
+                    enqueue_ns_.reset(new std::uint64_t[capacity_]());
+                    residency_.reset(new LatencyHistogram());
+                }
+            }
+
+            bool tracks_residency() const noexcept
+            {
+                return residency_ != nullptr;
+            }
+
+            /** @brief Residency percentiles in microseconds; all zero unless tracking is enabled. */
+            LatencyPercentiles residency() const noexcept
+            {
+                return residency_ ? residency_->snapshot() : LatencyPercentiles{};
+            }
+
+            std::uint64_t peak_size() const noexcept
+            {
+                return peak_size_.load(boost::memory_order_relaxed);
+            }
+
+            std::size_t capacity() const noexcept
+            {
+                return capacity_;
+            }
+
+        protected:
+            queue_core(std::size_t capacity, OverflowPolicy policy)
+                : capacity_(capacity), policy_(policy)
+            {
+                if (policy == OverflowPolicy::DropOldest && kSingleProducerConsumer)
+                {
+                    // Evicting means popping from the producer side, which a SPSC ring forbids.
+                    throw std::invalid_argument("OverflowPolicy::DropOldest requires mpmc_topology");
+                }
+            }
+            ~queue_core() = default;
+
+            template <typename TryPush>
+            bool push_(TryPush try_push) noexcept
+            {
+                if (is_closed())
+                {
+                    bump_(dropped_);
+                    return false;
+                }
+
+                if (try_push())
+                {
+                    on_pushed_();
+                    return true;
+                }
+
+                bump_(dropped_);
+                return false;
+            }
+
+            template <typename TryPush>
+            bool push_blocking_(TryPush try_push) noexcept
+            {
+                bool blocked = false;
+                for (;;)
+                {
+                    if (is_closed())
+                    {
+                        bump_(dropped_);
+                        return false;
+                    }
+
+                    if (try_push())
+                    {
+                        on_pushed_();
+                        return true;
+                    }
+
+                    if (!blocked)
+                    {
+                        blocked = true;
+                        bump_(blocked_);
+                    }
+                    await_(not_full_, [this] {
+                        return is_closed() || approximate_size() < capacity_;
+                    });
+                }
+            }
+
+            template <typename TryPush>
+            bool push_until_(TryPush try_push, std::chrono::steady_clock::time_point deadline) noexcept
+            {
+                bool blocked = false;
+                for (;;)
+                {
+                    if (is_closed())
+                    {
+                        bump_(dropped_);
+                        return false;
+                    }
+
+                    if (try_push())
+                    {
+                        on_pushed_();
+                        return true;
+                    }
+
+                    if (!blocked)
+                    {
+                        blocked = true;
+                        bump_(blocked_);
+                    }
+                    if (!await_until_(not_full_, deadline, [this] {
+                            return is_closed() || approximate_size() < capacity_;
+                        }))
+                    {
+                        bump_(dropped_);
+                        return false;
+                    }
+                }
+            }
+
+            template <typename TryPop>
+            bool wait_pop_(TryPop try_pop) noexcept
+            {
+                for (;;)
+                {
+                    if (try_pop())
+                    {
+                        return true;
+                    }
+
+                    if (is_closed())
+                    {
+                        return false;
+                    }
+
+                    await_(not_empty_, [this] {
+                        return is_closed() || approximate_size() > 0;
+                    });
+                }
+            }
+
+            template <typename TryPop>
+            bool wait_pop_until_(TryPop try_pop, std::chrono::steady_clock::time_point deadline) noexcept
+            {
+                for (;;)
+                {
+                    if (try_pop())
+                    {
+                        return true;
+                    }
+
+                    if (is_closed())
+                    {
+                        return false;
+                    }
+
+                    if (!await_until_(not_empty_, deadline, [this] {
+                            return is_closed() || approximate_size() > 0;
+                        }))
+                    {
+                        return try_pop();
+                    }
+                }
+            }
+
+            /**
+             * @brief DropOldest push: evicts through @p try_evict until @p try_push fits.
+             * @details @p try_evict pops and releases the oldest element; it may fail when a
+             * consumer emptied the queue meanwhile, and the push is then simply retried.
+             */
+            template <typename TryPush, typename TryEvict>
+            bool push_overwrite_(TryPush try_push, TryEvict try_evict) noexcept
+            {
+                if (is_closed())
+                {
+                    bump_(dropped_);
+                    return false;
+                }
+
+                while (!try_push())
+                {
+                    if (try_evict())
+                    {
+                        bump_(overwritten_);
+                        not_full_.notify_one();
+                    }
+                }
+                on_pushed_();
+                return true;
+            }
+
+            /**
+             * @brief CoalesceLatest push: ring while nothing is parked, else the latest slot.
+             * @details Once an element sits in the latest slot every newer one goes there too,
+             * until the consumer has drained the ring and taken it; FIFO order holds.
+             * @p store_latest returns true when it replaced an unread element.
+             */
+            template <typename TryPush, typename StoreLatest>
+            bool push_coalesce_(TryPush try_push, StoreLatest store_latest) noexcept
+            {
+                if (is_closed())
+                {
+                    bump_(dropped_);
+                    return false;
+                }
+
+                if (!static_cast<const Derived *>(this)->latest_pending_() && try_push())
+                {
+                    on_pushed_();
+                    return true;
+                }
+
+                if (store_latest())
+                {
+                    bump_(coalesced_);
+                }
+                not_empty_.notify_one();
+                ring_doorbell_();
+                return true;
+            }
+
+            /**
+             * @brief SPSC ring push that stamps residency timestamps when tracking is enabled.
+             * @details A stamp is written before its element becomes visible and only for ring
+             * slots that are free, so it never overwrites the stamp of a queued element.
+             */
+            template <typename Ring, typename U>
+            std::size_t ring_push_(Ring &ring, const U *items, std::size_t count) noexcept
+            {
+                if (enqueue_ns_)
+                {
+                    count = std::min(count, static_cast<std::size_t>(ring.write_available()));
+                    const std::uint64_t now = now_ns_();
+                    const std::uint64_t first = pushed_.load(boost::memory_order_relaxed);
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        enqueue_ns_[(first + i) % capacity_] = now;
+                    }
+                }
+                return ring.push(items, count);
+            }
+
+            // SPSC ring pop that records residency before the slots are handed back.
+            template <typename Ring, typename U>
+            std::size_t ring_pop_(Ring &ring, U *out, std::size_t count) noexcept
+            {
+                if (enqueue_ns_)
+                {
+                    count = std::min(count, static_cast<std::size_t>(ring.read_available()));
+                    const std::uint64_t now = now_ns_();
+                    const std::uint64_t first = popped_.load(boost::memory_order_relaxed);
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        const std::uint64_t stamped = enqueue_ns_[(first + i) % capacity_];
+                        residency_->record(now > stamped ? (now - stamped) / 1000u : 0);
+                    }
+                }
+                return ring.pop(out, count);
+            }
+
+            void on_coalesced_(std::uint64_t count) noexcept
+            {
+                bump_(coalesced_, count);
+            }
+
+            // Bookkeeping for a bulk push that accepted @p accepted of @p offered items.
+            void on_bulk_pushed_(std::size_t accepted, std::size_t offered) noexcept
+            {
+                if (accepted < offered)
+                {
+                    bump_(dropped_, offered - accepted);
+                }
+                if (accepted > 0)
+                {
+                    on_pushed_(accepted);
+                }
+            }
+
+            void on_pushed_(std::uint64_t count = 1) noexcept
+            {
+                bump_(pushed_, count);
+                update_peak_size_(ring_size_());
+                not_empty_.notify_one();
+                ring_doorbell_();
+            }
+
+            void on_popped_(std::uint64_t count = 1) noexcept
+            {
+                bump_(popped_, count);
+                not_full_.notify_one();
+            }
+
+        private:
+            // A selector has a single waiting consumer, so one wakeup always suffices.
+            void ring_doorbell_() noexcept
+            {
+                EventCount *doorbell = doorbell_.load(boost::memory_order_acquire);
+                if (doorbell != nullptr)
+                {
+                    doorbell->notify_one();
+                }
+            }
+
+            static std::uint64_t now_ns_() noexcept
+            {
+                return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                      std::chrono::steady_clock::now().time_since_epoch())
+                                                      .count());
+            }
+
+            std::uint64_t ring_size_() const noexcept
+            {
+                const auto pu = pushed_.load(boost::memory_order_relaxed);
+                const auto gone = popped_.load(boost::memory_order_relaxed) + overwritten_.load(boost::memory_order_relaxed);
+                return (pu > gone) ? (pu - gone) : 0;
+            }
+
+            // Sleeps once on @p ec unless @p ready already holds; callers loop and re-check.
+            template <typename Ready>
+            static void await_(EventCount &ec, Ready ready) noexcept
+            {
+                if (ready())
+                {
+                    return;
+                }
+                const EventCount::key_type key = ec.prepare_wait();
+                if (ready())
+                {
+                    ec.cancel_wait();
+                    return;
+                }
+                ec.wait(key);
+            }
+
+            // As await_, returning false once @p deadline has passed without a wakeup.
+            template <typename Ready>
+            static bool await_until_(EventCount &ec, std::chrono::steady_clock::time_point deadline, Ready ready) noexcept
+            {
+                if (ready())
+                {
+                    return true;
+                }
+                const EventCount::key_type key = ec.prepare_wait();
+                if (ready())
+                {
+                    ec.cancel_wait();
+                    return true;
+                }
+                return ec.wait_until(key, deadline);
+            }
+
+            // Returns the incremented value. With one producer and one consumer every counter
+            // has a single writer, so the increment needs no read-modify-write.
+            static std::uint64_t bump_(boost::atomic<std::uint64_t> &counter, std::uint64_t count = 1) noexcept
+            {
+                if constexpr (kSingleProducerConsumer)
+                {
+                    const std::uint64_t next = counter.load(boost::memory_order_relaxed) + count;
+                    counter.store(next, boost::memory_order_relaxed);
+                    return next;
+                }
+                else
+                {
+                    return counter.fetch_add(count, boost::memory_order_relaxed) + count;
+                }
+            }
+
+            void update_peak_size_(std::uint64_t candidate) noexcept
+            {
+                if constexpr (kSingleProducerConsumer)
+                {
+                    if (candidate > peak_size_.load(boost::memory_order_relaxed))
+                    {
+                        peak_size_.store(candidate, boost::memory_order_relaxed);
+                    }
+                    return;
+                }
+
+                std::uint64_t current_peak = peak_size_.load(boost::memory_order_relaxed);
+                while (candidate > current_peak &&
+                       !peak_size_.compare_exchange_weak(
+                           current_peak,
+                           candidate,
+                           boost::memory_order_relaxed,
+                           boost::memory_order_relaxed))
+                {
+                }
+            }
+
+            std::size_t capacity_;
+            OverflowPolicy policy_;
+
+            // Residency tracking (SPSC only): enqueue time per ring position, indexed by the
+            // element's ordinal (pushed_/popped_) modulo capacity.
+            std::unique_ptr<std::uint64_t[]> enqueue_ns_;
+            std::unique_ptr<LatencyHistogram> residency_;
+
+            // Futex wake syscalls happen only while a consumer or producer is actually parked.
+            EventCount not_empty_;
+            EventCount not_full_;
+            boost::atomic<EventCount *> doorbell_{nullptr};
+
+            boost::atomic<bool> closed_{false};
+            // Producer-side and consumer-side counters live on separate cache lines.
+            // coalesced_ is written by the producer of a SafeQueue, by the consumer of a
+            // SafeValueQueue; overwritten_ only exists for MPMC queues.
+            alignas(BOOST_LOCKFREE_CACHELINE_BYTES) boost::atomic<std::uint64_t> dropped_{0};
+            boost::atomic<std::uint64_t> pushed_{0};
+            boost::atomic<std::uint64_t> peak_size_{0};
+            boost::atomic<std::uint64_t> blocked_{0};
+            boost::atomic<std::uint64_t> overwritten_{0};
+            alignas(BOOST_LOCKFREE_CACHELINE_BYTES) boost::atomic<std::uint64_t> popped_{0};
+            boost::atomic<std::uint64_t> coalesced_{0};
+        };
+    } // namespace detail
+
+    /**
+     * @brief Lock-free queue for pointer payloads with shutdown-aware waits.
      * @tparam T Object type stored by pointer.
      * @tparam Disposer Callable used to release pointers after consumption.
+     * @tparam Topology @ref mpmc_topology or @ref spsc_topology, fixed at compile time.
      * @details Ownership is transferred to the queue only on successful push.
+     * Queue nodes for @p capacity entries are reserved up front and pushes never
+     * allocate, so capacity is a hard bound. With @ref OverflowPolicy::CoalesceLatest
+     * one extra element may wait in the latest slot beyond @p capacity.
      */
-    template <typename T, typename Disposer = default_disposer<T>>
-    class SafeQueue final
+    template <typename T, typename Disposer = default_disposer<T>, typename Topology = mpmc_topology>
+    class SafeQueue final : public detail::queue_core<SafeQueue<T, Disposer, Topology>, Topology>
     {
+        using core = detail::queue_core<SafeQueue<T, Disposer, Topology>, Topology>;
+        using core::kSingleProducerConsumer;
+        friend core;
+
     public:
         using value_type = T;
         using pointer = T *;
         using disposer_type = Disposer;
 
-        explicit SafeQueue(std::size_t capacity = 128, Disposer disposer = Disposer())
-            : queue_(capacity),
-              disposer_(std::move(disposer)),
-              capacity_(capacity)
+        /**
+         * @param policy Applied by @ref offer; @ref push and @ref push_blocking ignore it.
+         * @throws std::invalid_argument for @ref OverflowPolicy::DropOldest with @ref spsc_topology.
+         */
+        explicit SafeQueue(std::size_t capacity = 128, Disposer disposer = Disposer(),
+                           OverflowPolicy policy = OverflowPolicy::Block)
+            : core(capacity, policy),
+              queue_(capacity),
+              disposer_(std::move(disposer))
         {
             static_assert(std::is_trivially_copyable<pointer>::value,
                           "Queue element type must be trivially copyable.");
         }
 
-        SafeQueue(const SafeQueue &) = delete;
-        SafeQueue &operator=(const SafeQueue &) = delete;
-
         ~SafeQueue() noexcept
         {
-            close();
+            this->close();
             pointer p = nullptr;
             while (queue_.pop(p))
             {
                 disposer_(p);
             }
+            dispose(latest_.exchange(nullptr, boost::memory_order_acquire));
         }
 
-        void close() noexcept
+        /**
+         * @brief Enqueues @p p as the queue's @ref OverflowPolicy dictates when it is full.
+         * @return False when @p p was rejected (closed queue, or DropNewest on a full one);
+         * the caller then keeps ownership. Evicted or coalesced pointers are disposed here.
+         */
+        bool offer(pointer p) noexcept
         {
-            closed_.store(true, boost::memory_order_release);
-            cv_not_empty_.notify_all();
-            cv_not_full_.notify_all();
-        }
+            if (p == nullptr)
+            {
+                return false;
+            }
 
-        bool is_closed() const noexcept
-        {
-            return closed_.load(boost::memory_order_acquire);
+            switch (this->overflow_policy())
+            {
+            case OverflowPolicy::DropNewest:
+                return push(p);
+            case OverflowPolicy::DropOldest:
+                return this->push_overwrite_([&] { return enqueue_(p); },
+                                             [&] {
+                                                 pointer oldest = nullptr;
+                                                 if (!queue_.pop(oldest))
+                                                 {
+                                                     return false;
+                                                 }
+                                                 disposer_(oldest);
+                                                 return true;
+                                             });
+            case OverflowPolicy::CoalesceLatest:
+                return this->push_coalesce_([&] { return enqueue_(p); },
+                                            [&] {
+                                                pointer stale = latest_.exchange(p, boost::memory_order_acq_rel);
+                                                dispose(stale);
+                                                return stale != nullptr;
+                                            });
+            case OverflowPolicy::Block:
+            default:
+                return push_blocking(p);
+            }
         }
 
         bool push(pointer p) noexcept
@@ -83,218 +679,429 @@ namespace bms
             {
                 return false;
             }
-            if (is_closed())
+            return this->push_([&] { return enqueue_(p); });
+        }
+
+        bool push_blocking(pointer p) noexcept
+        {
+            if (p == nullptr)
             {
-                dropped_.fetch_add(1, boost::memory_order_relaxed);
                 return false;
             }
+            return this->push_blocking_([&] { return enqueue_(p); });
+        }
 
-            if (queue_.push(p))
+        template <typename Rep, typename Period>
+        bool push_for(pointer p, const std::chrono::duration<Rep, Period> &timeout) noexcept
+        {
+            if (p == nullptr)
             {
-                on_push_success_();
-                return true;
+                return false;
             }
-
-            dropped_.fetch_add(1, boost::memory_order_relaxed);
-            return false;
+            return this->push_until_([&] { return enqueue_(p); }, std::chrono::steady_clock::now() + timeout);
         }
 
-        bool push_blocking(pointer p) noexcept
+        /**
+         * @brief Pushes a run of pointers without blocking, with one counter update and one wakeup.
+         * @return Number of leading pointers accepted. The rest (counted as dropped, like a
+         * failed @ref push) stay owned by the caller.
+         * @pre No element of @p items is nullptr.
+         */
+        std::size_t push_bulk(std::span<const pointer> items) noexcept
         {
-            if (p == nullptr)
+            if (items.empty())
             {
-                return false;
+                return 0;
             }
 
-            for (;;)
+            std::size_t accepted = 0;
+            if (!this->is_closed())
             {
-                if (is_closed())
+                if constexpr (kSingleProducerConsumer)
                 {
-                    dropped_.fetch_add(1, boost::memory_order_relaxed);
-                    return false;
+                    accepted = this->ring_push_(queue_, items.data(), items.size());
                 }
-
-                if (queue_.push(p))
+                else
                 {
-                    on_push_success_();
-                    return true;
+                    while (accepted < items.size() && queue_.bounded_push(items[accepted]))
+                    {
+                        ++accepted;
+                    }
                 }
-
-                std::unique_lock<std::mutex> lock(cv_mutex_);
-                cv_not_full_.wait(lock, [this] {
-                    return is_closed() || approximate_size() < capacity_;
-                });
             }
+
+            this->on_bulk_pushed_(accepted, items.size());
+            return accepted;
         }
 
-        template <typename Rep, typename Period>
-        bool push_for(pointer p, const std::chrono::duration<Rep, Period> &timeout) noexcept
+        /**
+         * @brief Pops up to @c out.size() pointers in FIFO order, with one counter update and one wakeup.
+         * @return Number of pointers written to the front of @p out.
+         */
+        std::size_t pop_bulk(std::span<pointer> out) noexcept
         {
-            if (p == nullptr)
+            std::size_t n = 0;
+            if constexpr (kSingleProducerConsumer)
             {
-                return false;
+                n = this->ring_pop_(queue_, out.data(), out.size());
             }
-
-            const auto deadline = std::chrono::steady_clock::now() + timeout;
-            for (;;)
+            else
             {
-                if (is_closed())
-                {
-                    dropped_.fetch_add(1, boost::memory_order_relaxed);
-                    return false;
-                }
-
-                if (queue_.push(p))
+                while (n < out.size() && queue_.pop(out[n]))
                 {
-                    on_push_success_();
-                    return true;
+                    ++n;
                 }
+            }
 
-                std::unique_lock<std::mutex> lock(cv_mutex_);
-                if (!cv_not_full_.wait_until(lock, deadline, [this] {
-                        return is_closed() || approximate_size() < capacity_;
-                    }))
-                {
-                    dropped_.fetch_add(1, boost::memory_order_relaxed);
-                    return false;
-                }
+            if (n > 0)
+            {
+                this->on_popped_(n);
             }
+            if (n < out.size() && take_latest_(out[n]))
+            {
+                ++n;
+            }
+            return n;
         }
 
         bool try_pop(pointer &out) noexcept
         {
-            if (queue_.pop(out))
+            if (dequeue_(out))
             {
-                popped_.fetch_add(1, boost::memory_order_relaxed);
-                cv_not_full_.notify_one();
+                this->on_popped_();
                 return true;
             }
-            return false;
+            return take_latest_(out);
         }
 
         bool wait_and_pop(pointer &out) noexcept
         {
-            for (;;)
+            return this->wait_pop_([&] { return try_pop(out); });
+        }
+
+        template <typename Rep, typename Period>
+        bool wait_for_and_pop(pointer &out, const std::chrono::duration<Rep, Period> &timeout) noexcept
+        {
+            return this->wait_pop_until_([&] { return try_pop(out); }, std::chrono::steady_clock::now() + timeout);
+        }
+
+        void dispose(pointer p) noexcept
+        {
+            if (p != nullptr)
             {
-                if (try_pop(out))
-                {
-                    return true;
-                }
+                disposer_(p);
+            }
+        }
 
-                if (is_closed())
-                {
-                    return false;
-                }
+        const Disposer &disposer() const noexcept
+        {
+            return disposer_;
+        }
+
+    private:
+        bool latest_pending_() const noexcept
+        {
+            return latest_.load(boost::memory_order_relaxed) != nullptr;
+        }
+
+        // The latest slot is only read once the ring is empty, which keeps FIFO order.
+        bool take_latest_(pointer &out) noexcept
+        {
+            if (!latest_pending_())
+            {
+                return false;
+            }
+            out = latest_.exchange(nullptr, boost::memory_order_acquire);
+            return out != nullptr;
+        }
+
+        bool enqueue_(pointer p) noexcept
+        {
+            if constexpr (kSingleProducerConsumer)
+            {
+                return this->ring_push_(queue_, &p, 1) == 1;
+            }
+            else
+            {
+                return queue_.bounded_push(p);
+            }
+        }
+
+        bool dequeue_(pointer &out) noexcept
+        {
+            if constexpr (kSingleProducerConsumer)
+            {
+                return this->ring_pop_(queue_, &out, 1) == 1;
+            }
+            else
+            {
+                return queue_.pop(out);
+            }
+        }
+
+        using storage_type = typename std::conditional<kSingleProducerConsumer,
+                                                       boost::lockfree::spsc_queue<pointer>,
+                                                       boost::lockfree::queue<pointer>>::type;
+
+        storage_type queue_;
+        Disposer disposer_;
+        boost::atomic<pointer> latest_{nullptr};
+    };
+
+    /**
+     * @brief Lock-free queue that stores trivially copyable values inline, with the
+     * close/wait/diagnostics API of @ref SafeQueue.
+     * @tparam T Trivially copyable element type, copied in on push and out on pop.
+     * @tparam Topology @ref mpmc_topology or @ref spsc_topology, fixed at compile time.
+     * @details Nothing is allocated per element and there is no ownership to hand back.
+     * With @ref spsc_topology the elements live in one preallocated, cache-line-aligned
+     * ring, so a consumer draining with @ref pop_bulk reads contiguous memory. The MPMC
+     * storage is the node-based lock-free queue with all nodes reserved up front.
+     *
+     * @ref OverflowPolicy::CoalesceLatest keeps the latest value in a single-writer
+     * seqlock slot, which is why it needs @ref spsc_topology here. The consumer counts
+     * the versions it never saw as coalesced.
+     */
+    template <typename T, typename Topology = mpmc_topology>
+    class SafeValueQueue final : public detail::queue_core<SafeValueQueue<T, Topology>, Topology>
+    {
+        using core = detail::queue_core<SafeValueQueue<T, Topology>, Topology>;
+        using core::kSingleProducerConsumer;
+        friend core;
+
+        static_assert(std::is_trivially_copyable<T>::value, "SafeValueQueue elements must be trivially copyable.");
 
-                std::unique_lock<std::mutex> lock(cv_mutex_);
-                cv_not_empty_.wait(lock, [this] {
-                    return is_closed() || approximate_size() > 0;
-                });
+    public:
+        using value_type = T;
+
+        /**
+         * @param policy Applied by @ref offer; @ref push and @ref push_blocking ignore it.
+         * @throws std::invalid_argument for @ref OverflowPolicy::DropOldest with
+         * @ref spsc_topology, or @ref OverflowPolicy::CoalesceLatest with @ref mpmc_topology.
+         */
+        explicit SafeValueQueue(std::size_t capacity = 128, OverflowPolicy policy = OverflowPolicy::Block)
+            : core(capacity, policy),
+              queue_(capacity)
+        {
+            if (policy == OverflowPolicy::CoalesceLatest && !kSingleProducerConsumer)
+            {
+                throw std::invalid_argument("SafeValueQueue: OverflowPolicy::CoalesceLatest requires spsc_topology");
             }
         }
 
+        ~SafeValueQueue() noexcept
+        {
+            this->close();
+        }
+
+        /**
+         * @brief Enqueues @p value as the queue's @ref OverflowPolicy dictates when it is full.
+         * @return False when @p value was rejected (closed queue, or DropNewest on a full one).
+         */
+        bool offer(const T &value) noexcept
+        {
+            switch (this->overflow_policy())
+            {
+            case OverflowPolicy::DropNewest:
+                return push(value);
+            case OverflowPolicy::DropOldest:
+                return this->push_overwrite_([&] { return enqueue_(value); },
+                                             [&] {
+                                                 T oldest;
+                                                 return queue_.pop(oldest);
+                                             });
+            case OverflowPolicy::CoalesceLatest:
+                return this->push_coalesce_([&] { return enqueue_(value); },
+                                            [&] {
+                                                store_latest_(value);
+                                                return false; // counted by the consumer
+                                            });
+            case OverflowPolicy::Block:
+            default:
+                return push_blocking(value);
+            }
+        }
+
+        bool push(const T &value) noexcept
+        {
+            return this->push_([&] { return enqueue_(value); });
+        }
+
+        bool push_blocking(const T &value) noexcept
+        {
+            return this->push_blocking_([&] { return enqueue_(value); });
+        }
+
         template <typename Rep, typename Period>
-        bool wait_for_and_pop(pointer &out, const std::chrono::duration<Rep, Period> &timeout) noexcept
+        bool push_for(const T &value, const std::chrono::duration<Rep, Period> &timeout) noexcept
         {
-            const auto deadline = std::chrono::steady_clock::now() + timeout;
-            for (;;)
+            return this->push_until_([&] { return enqueue_(value); }, std::chrono::steady_clock::now() + timeout);
+        }
+
+        /**
+         * @brief Copies in a run of values without blocking, with one counter update and one wakeup.
+         * @return Number of leading values accepted; the rest are counted as dropped.
+         */
+        std::size_t push_bulk(std::span<const T> items) noexcept
+        {
+            if (items.empty())
+            {
+                return 0;
+            }
+
+            std::size_t accepted = 0;
+            if (!this->is_closed())
             {
-                if (try_pop(out))
+                if constexpr (kSingleProducerConsumer)
                 {
-                    return true;
+                    accepted = this->ring_push_(queue_, items.data(), items.size());
                 }
-
-                if (is_closed())
+                else
                 {
-                    return false;
+                    while (accepted < items.size() && queue_.bounded_push(items[accepted]))
+                    {
+                        ++accepted;
+                    }
                 }
+            }
 
-                std::unique_lock<std::mutex> lock(cv_mutex_);
-                if (!cv_not_empty_.wait_until(lock, deadline, [this] {
-                        return is_closed() || approximate_size() > 0;
-                    }))
+            this->on_bulk_pushed_(accepted, items.size());
+            return accepted;
+        }
+
+        /**
+         * @brief Copies out up to @c out.size() values in FIFO order, with one counter update and one wakeup.
+         * @return Number of values written to the front of @p out.
+         */
+        std::size_t pop_bulk(std::span<T> out) noexcept
+        {
+            std::size_t n = 0;
+            if constexpr (kSingleProducerConsumer)
+            {
+                n = this->ring_pop_(queue_, out.data(), out.size());
+            }
+            else
+            {
+                while (n < out.size() && queue_.pop(out[n]))
                 {
-                    return try_pop(out);
+                    ++n;
                 }
             }
+
+            if (n > 0)
+            {
+                this->on_popped_(n);
+            }
+            if (n < out.size() && take_latest_(out[n]))
+            {
+                ++n;
+            }
+            return n;
         }
 
-        std::uint64_t dropped_count() const noexcept
+        bool try_pop(T &out) noexcept
         {
-            return dropped_.load(boost::memory_order_relaxed);
+            if (dequeue_(out))
+            {
+                this->on_popped_();
+                return true;
+            }
+            return take_latest_(out);
         }
 
-        std::uint64_t total_pushed() const noexcept
+        bool wait_and_pop(T &out) noexcept
         {
-            return pushed_.load(boost::memory_order_relaxed);
+            return this->wait_pop_([&] { return try_pop(out); });
         }
 
-        std::uint64_t total_popped() const noexcept
+        template <typename Rep, typename Period>
+        bool wait_for_and_pop(T &out, const std::chrono::duration<Rep, Period> &timeout) noexcept
         {
-            return popped_.load(boost::memory_order_relaxed);
+            return this->wait_pop_until_([&] { return try_pop(out); }, std::chrono::steady_clock::now() + timeout);
         }
 
-        std::uint64_t approximate_size() const noexcept
+    private:
+        // An odd sequence means a write is in flight; the producer notifies once it lands.
+        bool latest_pending_() const noexcept
         {
-            const auto pu = pushed_.load(boost::memory_order_relaxed);
-            const auto po = popped_.load(boost::memory_order_relaxed);
-            return (pu > po) ? (pu - po) : 0;
+            const std::uint64_t seq = latest_seq_.load(boost::memory_order_acquire);
+            return (seq & 1) == 0 && seq != latest_taken_.load(boost::memory_order_relaxed);
         }
 
-        std::uint64_t peak_size() const noexcept
+        // Producer only: seqlock write of the latest slot.
+        void store_latest_(const T &value) noexcept
         {
-            return peak_size_.load(boost::memory_order_relaxed);
+            const std::uint64_t seq = latest_seq_.load(boost::memory_order_relaxed);
+            latest_seq_.store(seq + 1, boost::memory_order_relaxed);
+            boost::atomic_thread_fence(boost::memory_order_release);
+            std::memcpy(static_cast<void *>(&latest_), &value, sizeof(T));
+            latest_seq_.store(seq + 2, boost::memory_order_release);
         }
 
-        void dispose(pointer p) noexcept
+        // Consumer only, after the ring came up empty, so FIFO order holds.
+        bool take_latest_(T &out) noexcept
         {
-            if (p != nullptr)
+            for (;;)
             {
-                disposer_(p);
-            }
-        }
+                if (!latest_pending_())
+                {
+                    return false;
+                }
+                const std::uint64_t seq = latest_seq_.load(boost::memory_order_acquire);
+                std::memcpy(static_cast<void *>(&out), &latest_, sizeof(T));
+                boost::atomic_thread_fence(boost::memory_order_acquire);
+                if (latest_seq_.load(boost::memory_order_relaxed) != seq)
+                {
+                    continue; // overwritten mid-copy; the newer value replaces it
+                }
 
-        std::size_t capacity() const noexcept
-        {
-            return capacity_;
+                const std::uint64_t taken = latest_taken_.load(boost::memory_order_relaxed);
+                const std::uint64_t skipped = (seq - taken) / 2 - 1;
+                if (skipped > 0)
+                {
+                    this->on_coalesced_(skipped);
+                }
+                latest_taken_.store(seq, boost::memory_order_relaxed);
+                return true;
+            }
         }
 
-    private:
-        void on_push_success_() noexcept
+        bool enqueue_(const T &value) noexcept
         {
-            const std::uint64_t pushed_now = pushed_.fetch_add(1, boost::memory_order_relaxed) + 1;
-            const std::uint64_t popped_now = popped_.load(boost::memory_order_relaxed);
-            const std::uint64_t approx_now = (pushed_now > popped_now) ? (pushed_now - popped_now) : 0;
-            update_peak_size_(approx_now);
-            cv_not_empty_.notify_one();
+            if constexpr (kSingleProducerConsumer)
+            {
+                return this->ring_push_(queue_, &value, 1) == 1;
+            }
+            else
+            {
+                return queue_.bounded_push(value);
+            }
         }
 
-        void update_peak_size_(std::uint64_t candidate) noexcept
+        bool dequeue_(T &out) noexcept
         {
-            std::uint64_t current_peak = peak_size_.load(boost::memory_order_relaxed);
-            while (candidate > current_peak &&
-                   !peak_size_.compare_exchange_weak(
-                       current_peak,
-                       candidate,
-                       boost::memory_order_relaxed,
-                       boost::memory_order_relaxed))
+            if constexpr (kSingleProducerConsumer)
             {
+                return this->ring_pop_(queue_, &out, 1) == 1;
+            }
+            else
+            {
+                return queue_.pop(out);
             }
         }
 
-        boost::lockfree::queue<pointer> queue_;
-        Disposer disposer_;
-        std::size_t capacity_;
+        using ring_allocator = boost::alignment::aligned_allocator<T, BOOST_LOCKFREE_CACHELINE_BYTES>;
+        using storage_type = typename std::conditional<
+            kSingleProducerConsumer,
+            boost::lockfree::spsc_queue<T, boost::lockfree::allocator<ring_allocator>>,
+            boost::lockfree::queue<T>>::type;
 
-        mutable std::mutex cv_mutex_;
-        std::condition_variable cv_not_empty_;
-        std::condition_variable cv_not_full_;
+        storage_type queue_;
 
-        boost::atomic<bool> closed_{false};
-        boost::atomic<std::uint64_t> dropped_{0};
-        boost::atomic<std::uint64_t> pushed_{0};
-        boost::atomic<std::uint64_t> popped_{0};
-        boost::atomic<std::uint64_t> peak_size_{0};
+        // Latest slot for OverflowPolicy::CoalesceLatest; the sequence advances by two per write.
+        alignas(BOOST_LOCKFREE_CACHELINE_BYTES) boost::atomic<std::uint64_t> latest_seq_{0};
+        T latest_{};
+        alignas(BOOST_LOCKFREE_CACHELINE_BYTES) boost::atomic<std::uint64_t> latest_taken_{0};
     };
 
 } // namespace bms
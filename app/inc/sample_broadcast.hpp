@@ -0,0 +1,189 @@
+/**
+ * @file sample_broadcast.hpp
+ * @brief Fan-out of samples to several consumer queues through shared pooled slots or inline copies.
+ */
+
+#pragma once
+
+#include "object_pool.hpp"
+#include "safe_queue.hpp"
+
+#include <boost/atomic.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace bms
+{
+    template <typename T, typename Topology>
+    class SampleBroadcast;
+
+    /**
+     * @brief @ref SafeQueue disposer that drops one reference to a broadcast slot.
+     */
+    template <typename T, typename Topology>
+    struct broadcast_disposer
+    {
+        explicit broadcast_disposer(SampleBroadcast<T, Topology> &owner) noexcept : owner(&owner) {}
+
+        void operator()(T *p) const noexcept { owner->release(p); }
+
+        SampleBroadcast<T, Topology> *owner;
+    };
+
+    /**
+     * @brief Publishes each sample once and hands the same read-only slot to every pointer subscriber.
+     * @tparam T Sample type; consumers must treat popped pointers as const.
+     * @tparam Topology Topology of the subscriber queues. With @ref spsc_topology,
+     * @ref publish must only ever be called from one thread and each queue drained by one.
+     * @details The producer copies a sample into one pooled slot whose reference count is
+     * the number of subscribers, then pushes that pointer into each subscriber's queue.
+     * Every queue acts as its consumer's private read cursor over the shared samples;
+     * disposing a popped pointer (or failing to enqueue it) drops one reference and the
+     * last one returns the slot to the pool. Adding a consumer therefore costs one queue
+     * push per sample, with no copy and no allocation.
+     *
+     * Consumers that copy every sample anyway can subscribe a @ref SafeValueQueue
+     * instead; they get their own inline copy and drain contiguous memory, and take no
+     * pool slot.
+     *
+     * What happens when a subscriber's queue is full is that queue's @ref OverflowPolicy:
+     * @ref publish hands every sample to @c offer. A Block queue gates the producer at its
+     * consumer's pace; the other policies never stall it.
+     *
+     * Subscribe every queue before the first @ref publish. Size @p slot_count to the sum
+     * of the pointer-subscribed queue capacities plus one slot per such consumer (two
+     * with CoalesceLatest, for the latest slot) and one for the producer, so that the
+     * pool can never be exhausted.
+     */
+    template <typename T, typename Topology = mpmc_topology>
+    class SampleBroadcast final
+    {
+    public:
+        using disposer_type = broadcast_disposer<T, Topology>;
+        using queue_type = SafeQueue<T, disposer_type, Topology>;
+        using value_queue_type = SafeValueQueue<T, Topology>;
+
+        explicit SampleBroadcast(std::size_t slot_count)
+            : pool_(slot_count),
+              refs_(new boost::atomic<std::uint32_t>[slot_count])
+        {
+            for (std::size_t i = 0; i < slot_count; ++i)
+            {
+                refs_[i].store(0, boost::memory_order_relaxed);
+            }
+        }
+
+        SampleBroadcast(const SampleBroadcast &) = delete;
+        SampleBroadcast &operator=(const SampleBroadcast &) = delete;
+
+        /** @brief Disposer to construct subscriber queues with. */
+        disposer_type disposer() noexcept
+        {
+            return disposer_type(*this);
+        }
+
+        /**
+         * @brief Registers a consumer queue built with @ref disposer.
+         * @throws std::invalid_argument when the queue belongs to another broadcast.
+         */
+        void subscribe(queue_type &queue)
+        {
+            if (queue.disposer().owner != this)
+            {
+                throw std::invalid_argument("SampleBroadcast: queue was built with another broadcast's disposer");
+            }
+            subscribers_.push_back(&queue);
+        }
+
+        /** @brief Registers a consumer that receives its own copy of each sample. */
+        void subscribe(value_queue_type &queue)
+        {
+            value_subscribers_.push_back(&queue);
+        }
+
+        /**
+         * @brief Offers @p sample to every subscriber: a copy per value queue, then one
+         * shared slot for all pointer queues.
+         * @return Number of subscribers that received the sample.
+         */
+        std::size_t publish(const T &sample) noexcept
+        {
+            published_.fetch_add(1, boost::memory_order_relaxed);
+
+            std::size_t delivered = 0;
+            for (value_queue_type *queue : value_subscribers_)
+            {
+                delivered += queue->offer(sample) ? 1 : 0;
+            }
+
+            if (subscribers_.empty())
+            {
+                return delivered;
+            }
+
+            T *slot = pool_.acquire(sample);
+            if (slot == nullptr)
+            {
+                return delivered;
+            }
+
+            // Each subscriber owns one reference whether or not its push succeeds; the slot
+            // stays alive until the last push below has been attempted.
+            refs_[pool_.index_of(slot)].store(static_cast<std::uint32_t>(subscribers_.size()),
+                                              boost::memory_order_relaxed);
+
+            for (queue_type *queue : subscribers_)
+            {
+                if (queue->offer(slot))
+                {
+                    ++delivered;
+                }
+                else
+                {
+                    release(slot);
+                }
+            }
+            return delivered;
+        }
+
+        /** @brief Drops one reference to @p p; the last one returns the slot to the pool. */
+        void release(T *p) noexcept
+        {
+            if (p == nullptr)
+            {
+                return;
+            }
+            if (refs_[pool_.index_of(p)].fetch_sub(1, boost::memory_order_acq_rel) == 1)
+            {
+                pool_.release(p);
+            }
+        }
+
+        std::uint64_t published_count() const noexcept
+        {
+            return published_.load(boost::memory_order_relaxed);
+        }
+
+        std::size_t subscriber_count() const noexcept
+        {
+            return subscribers_.size() + value_subscribers_.size();
+        }
+
+        const ObjectPool<T> &pool() const noexcept
+        {
+            return pool_;
+        }
+
+    private:
+        ObjectPool<T> pool_;
+        std::unique_ptr<boost::atomic<std::uint32_t>[]> refs_;
+        std::vector<queue_type *> subscribers_;
+        std::vector<value_queue_type *> value_subscribers_;
+        boost::atomic<std::uint64_t> published_{0};
+    };
+
+} // namespace bms
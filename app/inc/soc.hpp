@@ -9,8 +9,11 @@
 #pragma once
 
 #include "batch_structures.hpp"
+#include "queue_selector.hpp"
 #include "safe_queue.hpp"
+#include "sample_broadcast.hpp"
 
+#include <cstddef>
 #include <cstdint>
 #include <optional>
 
@@ -41,8 +44,8 @@ namespace bms
     class SoCTask final
     {
     public:
-        using VoltageQueue = SafeQueue<VoltageCurrentSample>;
-        using TemperatureQueue = SafeQueue<TemperatureSample>;
+        using VoltageQueue = SampleBroadcast<VoltageCurrentSample, spsc_topology>::value_queue_type;
+        using TemperatureQueue = SampleBroadcast<TemperatureSample, spsc_topology>::value_queue_type;
 
         /**
          * @brief Creates the SoC task bound to queue inputs.
@@ -59,9 +62,17 @@ namespace bms
         const SoCTaskDiagnostics &diagnostics() const noexcept { return diag_; }
 
     private:
+        // Samples copied out per pop_bulk call while draining a queue.
+        static constexpr std::size_t kDrainBatch = 64;
+
+        void refresh_temperature_();
+        void consume_voltage_(const VoltageCurrentSample &sample);
+
         SoCTaskConfig cfg_;
         VoltageQueue &voltage_queue_;
         TemperatureQueue &temperature_queue_;
+        QueueSelector selector_;
+        std::size_t temperature_source_{0};
         std::optional<TemperatureSample> latest_temperature_{};
         SoCTaskDiagnostics diag_{};
     };
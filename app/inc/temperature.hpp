@@ -6,7 +6,10 @@
 #pragma once
 
 #include "batch_structures.hpp"
+#include "clock_sync.hpp"
 #include "modbus_reader.hpp"
+#include "register_log.hpp"
+#include "rtc_discipline.hpp"
 
 #include <array>
 #include <atomic>
@@ -24,6 +27,8 @@ namespace bms
     struct TemperatureAcquisitionConfig final
     {
         ModbusTcpConfig device{};
+        ClockEstimatorConfig clock_estimator{};
+        RtcDisciplineConfig rtc{};
         bool enable_sample_logging{true};
         std::uint64_t diagnostics_every_cycles{0};
     };
@@ -36,7 +41,16 @@ namespace bms
         std::atomic<std::uint64_t> attempts{0};
         std::atomic<std::uint64_t> successes{0};
         std::atomic<std::uint64_t> failures{0};
+        std::atomic<std::uint64_t> skipped{0}; // Failed fast on an open circuit
         std::atomic<std::int64_t> last_cycle_duration_ms{0};
+
+        // Device clock estimate (device minus host); see ClockOffsetEstimator.
+        std::atomic<std::int64_t> clock_offset_us{0};
+        std::atomic<std::int64_t> clock_drift_ppb{0};
+        std::atomic<std::int64_t> clock_uncertainty_us{0};
+        std::atomic<std::uint64_t> host_time_fallbacks{0}; // Stamped without a valid device clock
+        std::atomic<std::uint64_t> rtc_corrections{0};
+        std::atomic<std::uint64_t> rtc_write_failures{0};
     };
 
     /**
@@ -75,6 +89,19 @@ namespace bms
          */
         void operator()();
 
+        /**
+         * @brief Runs the decode/publish half of a cycle on a previously captured read.
+         * @details Used by register log replay; no I/O and no RTC corrections. Must not run
+         * concurrently with @ref operator()().
+         */
+        void ingest(const TimedBlockRead &read);
+
+        /**
+         * @brief Logs every raw block read to @p recorder (non-owning; nullptr disables).
+         * @note Set before the periodic task starts.
+         */
+        void set_recorder(RegisterRecorder *recorder) noexcept { recorder_ = recorder; }
+
         const TemperatureAcquisitionConfig &config() const noexcept { return cfg_; }
         const TemperatureAcquisitionDiagnostics &diagnostics() const noexcept { return diagnostics_; }
         const ModbusStatus &device_status() const noexcept { return device_.status(); }
@@ -85,20 +112,23 @@ namespace bms
         void set_sample_callback(SampleCallback callback) { on_sample_ = std::move(callback); }
 
     private:
-        static float decode_channel_(const std::array<std::uint16_t, kRegisterBlockCount> &regs,
-                                     std::size_t channel_index) noexcept;
         static std::string format_timestamp_(std::chrono::system_clock::time_point tp);
 
         void log_success_(const TemperatureSample &sample);
         void log_failure_();
         void log_diagnostics_();
+        void log_diagnostics_if_due_();
+        void process_cycle_(const TimedBlockRead &read);
 
         TemperatureAcquisitionConfig cfg_;
         ModbusTcpClient device_;
+        ClockOffsetEstimator clock_;
+        RtcDiscipline rtc_;
 
         TemperatureAcquisitionDiagnostics diagnostics_{};
         std::uint64_t sequence_{0};
         SampleCallback on_sample_{};
+        RegisterRecorder *recorder_{nullptr};
     };
 
 } // namespace bms
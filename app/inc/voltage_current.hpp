@@ -6,13 +6,20 @@
 #pragma once
 
 #include "batch_structures.hpp"
+#include "clock_sync.hpp"
 #include "modbus_reader.hpp"
+#include "register_log.hpp"
+#include "rtc_discipline.hpp"
+
+#include <boost/thread/thread.hpp>
 
 #include <array>
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <functional>
+#include <mutex>
 #include <string>
 #include <utility>
 
@@ -30,7 +37,12 @@ namespace bms
         std::size_t current_source_channel{7};
         float current_scale_a_per_v{1.0F};
         float current_offset_a{0.0F};
+        float cell_voltage_min_v{0.0F}; // Cells outside [min, max] are flagged RangeError
+        float cell_voltage_max_v{5.0F};
         bool enable_sample_logging{true};
+        bool publish_partial_samples{true}; // Emit NaN-filled samples when one device fails
+        ClockEstimatorConfig clock_estimator{};
+        RtcDisciplineConfig rtc{}; // Applied to both devices
         std::uint64_t diagnostics_every_cycles{0};
     };
 
@@ -73,19 +85,37 @@ namespace bms
         std::atomic<std::uint64_t> pair_attempts{0};
         std::atomic<std::uint64_t> pair_successes{0};
         std::atomic<std::uint64_t> pair_failures{0};
+        std::atomic<std::uint64_t> partial_samples{0}; // Published with one half missing
 
         std::atomic<std::uint64_t> device1_successes{0};
         std::atomic<std::uint64_t> device1_failures{0};
         std::atomic<std::uint64_t> device2_successes{0};
         std::atomic<std::uint64_t> device2_failures{0};
+        std::atomic<std::uint64_t> device1_skipped{0}; // Failed fast on an open circuit
+        std::atomic<std::uint64_t> device2_skipped{0};
 
         std::atomic<std::int64_t> last_cycle_duration_ms{0};
+        std::atomic<std::int64_t> last_device_skew_us{0};
+
+        // Device clock estimates (device minus host); see ClockOffsetEstimator.
+        std::atomic<std::int64_t> device1_clock_offset_us{0};
+        std::atomic<std::int64_t> device1_clock_drift_ppb{0};
+        std::atomic<std::int64_t> device1_clock_uncertainty_us{0};
+        std::atomic<std::int64_t> device2_clock_offset_us{0};
+        std::atomic<std::int64_t> device2_clock_drift_ppb{0};
+        std::atomic<std::int64_t> device2_clock_uncertainty_us{0};
+        std::atomic<std::uint64_t> host_time_fallbacks{0}; // Stamped without a valid device clock
+        std::atomic<std::uint64_t> device1_rtc_corrections{0};
+        std::atomic<std::uint64_t> device2_rtc_corrections{0};
+        std::atomic<std::uint64_t> rtc_write_failures{0};
     };
 
     /**
      * @brief Periodic acquisition functor for pack voltage and current samples.
      * @details The task reads one canonical MODBUS block from each configured device and
-     * maps decoded channels into a single @ref VoltageCurrentSample.
+     * maps decoded channels into a single @ref VoltageCurrentSample. Both devices are
+     * read concurrently: device 1 on the calling thread and device 2 on a companion
+     * reader thread owned by the task, so the cycle costs roughly one round-trip.
      */
     class VoltageCurrentAcquisition final
     {
@@ -102,6 +132,8 @@ namespace bms
          */
         explicit VoltageCurrentAcquisition(VoltageCurrentAcquisitionConfig cfg);
 
+        ~VoltageCurrentAcquisition();
+
         VoltageCurrentAcquisition(const VoltageCurrentAcquisition &) = delete;
         VoltageCurrentAcquisition &operator=(const VoltageCurrentAcquisition &) = delete;
 
@@ -121,6 +153,19 @@ namespace bms
          */
         void operator()();
 
+        /**
+         * @brief Runs the decode/publish half of a cycle on previously captured reads.
+         * @details Used by register log replay; no I/O and no RTC corrections. Must not run
+         * concurrently with @ref operator()().
+         */
+        void ingest(const TimedBlockRead &read1, const TimedBlockRead &read2);
+
+        /**
+         * @brief Logs every raw block read to @p recorder (non-owning; nullptr disables).
+         * @note Set before the periodic task starts.
+         */
+        void set_recorder(RegisterRecorder *recorder) noexcept { recorder_ = recorder; }
+
         const VoltageCurrentAcquisitionConfig &config() const noexcept { return cfg_; }
         const VoltageCurrentAcquisitionDiagnostics &diagnostics() const noexcept { return diagnostics_; }
 
@@ -133,14 +178,24 @@ namespace bms
         void set_sample_callback(SampleCallback callback) { on_sample_ = std::move(callback); }
 
     private:
-        static float decode_channel_(const std::array<std::uint16_t, kRegisterBlockCount> &regs,
-                                     std::size_t channel_index) noexcept;
+        static void timed_read_(ModbusTcpClient &device, TimedBlockRead &out);
+        static void export_clock_(const ClockOffsetEstimator &clock,
+                                  std::atomic<std::int64_t> &offset_us,
+                                  std::atomic<std::int64_t> &drift_ppb,
+                                  std::atomic<std::int64_t> &uncertainty_us);
+
+        void start_device2_read_();
+        void wait_device2_read_();
+        void device2_reader_loop_();
 
         static std::string format_timestamp_(std::chrono::system_clock::time_point tp);
 
         void log_success_(const VoltageCurrentSample &sample);
         void log_failure_(bool dev1_ok, bool dev2_ok);
         void log_diagnostics_();
+        void log_diagnostics_if_due_();
+        void process_cycle_(const TimedBlockRead &read1, const TimedBlockRead &read2);
+        void discipline_clocks_(bool dev1_ok, bool dev2_ok);
 
         VoltageCurrentAcquisitionConfig cfg_;
 
@@ -148,9 +203,24 @@ namespace bms
         ModbusTcpClient dev2_;
         CurrentConverter converter_;
         SampleCallback on_sample_{};
+        RegisterRecorder *recorder_{nullptr};
+
+        ClockOffsetEstimator clock1_;
+        ClockOffsetEstimator clock2_;
+        RtcDiscipline rtc1_;
+        RtcDiscipline rtc2_;
 
         VoltageCurrentAcquisitionDiagnostics diagnostics_{};
         std::uint64_t sequence_{0};
+
+        // Companion reader handshake: one request/completion generation per cycle.
+        TimedBlockRead dev2_result_{};
+        std::mutex dev2_mutex_;
+        std::condition_variable dev2_cv_;
+        std::uint64_t dev2_requested_{0};
+        std::uint64_t dev2_completed_{0};
+        bool dev2_stop_{false};
+        boost::thread dev2_thread_;
     };
 
 } // namespace bms
@@ -0,0 +1,190 @@
+/**
+ * @file device_simulator.hpp
+ * @brief Local MODBUS/TCP stand-in for the BMS acquisition boards, with fault injection.
+ */
+
+#pragma once
+
+#include <boost/atomic.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bms::sim
+{
+    /**
+     * @brief Which physical board a simulated device impersonates.
+     */
+    enum class DeviceProfile : std::uint8_t
+    {
+        VoltageBoardA, // Cells 1..8
+        VoltageBoardB, // Cells 9..15 + current sensor
+        Temperature    // 16 temperature channels
+    };
+
+    const char *to_string(DeviceProfile profile) noexcept;
+
+    /**
+     * @brief Added response latency (on top of the real loopback RTT).
+     * @details Spec syntax: @c const:MS, @c uniform:LO_MS:HI_MS, @c normal:MEAN_MS:SD_MS,
+     * @c lognormal:MEDIAN_MS:SIGMA (heavy tail, sigma in log space).
+     */
+    struct LatencyModel final
+    {
+        enum class Kind : std::uint8_t
+        {
+            Constant,
+            Uniform,
+            Normal,
+            LogNormal
+        };
+
+        Kind kind{Kind::Constant};
+        double a{0.0};
+        double b{0.0};
+
+        static std::optional<LatencyModel> parse(std::string_view spec);
+        std::chrono::microseconds sample(std::mt19937_64 &rng) const;
+    };
+
+    /**
+     * @brief Per-request fault probabilities and durations.
+     */
+    struct FaultProfile final
+    {
+        LatencyModel latency{};
+        double drop_probability{0.0};  // Request read, no reply sent
+        double reset_probability{0.0}; // Connection aborted with RST instead of a reply
+        double stall_probability{0.0}; // Device hangs: swallows requests for stall_ms
+        int stall_ms{3000};
+    };
+
+    /**
+     * @brief One timed change of the fault profile (see @ref parse_fault_script).
+     */
+    struct FaultScriptStep final
+    {
+        double at_s{0.0}; // Seconds since simulator start
+        std::optional<LatencyModel> latency;
+        std::optional<double> drop_probability;
+        std::optional<double> reset_probability;
+        std::optional<double> stall_probability;
+        std::optional<int> stall_ms;
+        std::optional<double> outage_s; // Refuse and close all connections for this long
+    };
+
+    /**
+     * @brief Parses a fault script: one step per line, @c "<seconds> key=value ...".
+     * @details Keys: latency, drop, reset, stall, stall_ms, outage. Blank lines and
+     * @c # comments are ignored. Steps are returned sorted by time.
+     * @param text Script contents.
+     * @param error Receives a line-numbered message on failure.
+     * @return Parsed steps, or std::nullopt on a syntax error.
+     */
+    std::optional<std::vector<FaultScriptStep>> parse_fault_script(std::string_view text, std::string &error);
+
+    /**
+     * @brief Endpoint, waveform and clock settings of one simulated device.
+     */
+    struct SimDeviceConfig final
+    {
+        DeviceProfile profile{DeviceProfile::VoltageBoardA};
+        std::string bind_address{"127.0.0.1"};
+        int port{1502};
+        int unit_id{1};
+        double clock_offset_ms{0.0}; // Initial RTC error (device minus host)
+        double clock_drift_ppm{0.0}; // RTC rate error
+        double noise_scale{1.0};     // Multiplies the waveform noise amplitude
+        FaultProfile faults{};
+        std::uint64_t seed{1};
+    };
+
+    /**
+     * @brief Counters of one simulated device.
+     */
+    struct SimDeviceStats final
+    {
+        boost::atomic<std::uint64_t> connections{0};
+        boost::atomic<std::uint64_t> requests{0};
+        boost::atomic<std::uint64_t> replies{0};
+        boost::atomic<std::uint64_t> dropped{0};
+        boost::atomic<std::uint64_t> resets{0};
+        boost::atomic<std::uint64_t> stalls{0};
+        boost::atomic<std::uint64_t> refused{0}; // Connections closed during an outage
+        boost::atomic<std::uint64_t> rtc_writes{0};
+    };
+
+    /**
+     * @brief Serves the canonical 35-register block (input registers 3..37) of one board.
+     * @details Registers 3..5 carry the device RTC (epoch2000 hi/lo + ms) and registers
+     * 6.. hold float32 channels laid out by the matching register map. Holding
+     * registers 290..292 accept RTC writes like the real boards. Values are regenerated
+     * on every request from smooth waveforms plus noise. Each device runs one server
+     * thread; requests are answered in arrival order, so injected latency and stalls
+     * delay every connection of the device, as on the real single-threaded firmware.
+     */
+    class DeviceSimulator final
+    {
+    public:
+        explicit DeviceSimulator(SimDeviceConfig cfg);
+        ~DeviceSimulator();
+
+        DeviceSimulator(const DeviceSimulator &) = delete;
+        DeviceSimulator &operator=(const DeviceSimulator &) = delete;
+
+        /**
+         * @brief Binds the listening socket and starts the server thread.
+         * @return False when the socket could not be bound (reason on stderr).
+         */
+        bool start();
+        /** @brief Stops the server thread and closes all connections. */
+        void stop();
+
+        /** @brief Replaces the fault profile; takes effect on the next request. */
+        void set_faults(const FaultProfile &faults);
+        FaultProfile faults() const;
+        /** @brief Closes all connections and refuses new ones for @p duration. */
+        void begin_outage(std::chrono::milliseconds duration);
+
+        const SimDeviceConfig &config() const noexcept { return cfg_; }
+        const SimDeviceStats &stats() const noexcept { return stats_; }
+
+    private:
+        using clock = std::chrono::system_clock;
+
+        void serve_loop_();
+        void handle_request_(int fd, std::vector<int> &clients);
+        void refresh_registers_(clock::time_point now);
+        void apply_rtc_write_(bool with_millis);
+        clock::time_point device_time_(clock::time_point now) const;
+
+        SimDeviceConfig cfg_;
+        SimDeviceStats stats_{};
+
+        mutable std::mutex faults_mutex_;
+        FaultProfile faults_;
+        boost::atomic<std::int64_t> outage_until_ms_{0}; // Steady-clock ms; 0 = none
+
+        void *ctx_{nullptr};     // Opaque modbus_t*
+        void *mapping_{nullptr}; // Opaque modbus_mapping_t*
+        int listen_fd_{-1};
+        std::chrono::steady_clock::time_point started_{};
+        std::chrono::steady_clock::time_point stalled_until_{};
+        std::mt19937_64 rng_;
+
+        // RTC model: device = host + offset + drift * (host - anchor)
+        clock::time_point rtc_anchor_{};
+        double rtc_offset_s_{0.0};
+
+        boost::atomic<bool> stop_{false};
+        boost::thread thread_;
+    };
+
+} // namespace bms::sim
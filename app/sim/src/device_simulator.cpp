@@ -0,0 +1,584 @@
+/**
+ * @file device_simulator.cpp
+ * @brief libmodbus server-mode implementation of the simulated BMS boards.
+ */
+
+#include "device_simulator.hpp"
+
+#include "batch_structures.hpp"
+#include "register_map.hpp"
+
+#include <modbus/modbus.h>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <utility>
+
+namespace bms::sim
+{
+    namespace
+    {
+        constexpr int kRtcRegister = 290;  // Holding registers: epoch hi, epoch lo, ms
+        constexpr int kRtcRegisterCount = 3;
+        constexpr double kTwoPi = 6.283185307179586;
+
+        modbus_t *as_modbus(void *p) noexcept { return static_cast<modbus_t *>(p); }
+        modbus_mapping_t *as_mapping(void *p) noexcept { return static_cast<modbus_mapping_t *>(p); }
+
+        std::int64_t steady_ms() noexcept
+        {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+        }
+
+        bool parse_double(std::string_view text, double &out)
+        {
+            try
+            {
+                std::size_t used = 0;
+                out = std::stod(std::string(text), &used);
+                return used == text.size();
+            }
+            catch (const std::exception &)
+            {
+                return false;
+            }
+        }
+
+        /** @brief Writes the float32 fields of @p Map into @p block using @p value_of(index). */
+        template <typename Map, typename ValueFn>
+        void encode_map(std::uint16_t *block, ValueFn &&value_of)
+        {
+            for (std::size_t i = 0; i < Map::kFields.size(); ++i)
+            {
+                const RegisterField &field = Map::kFields[i];
+                if (field.type != RegisterType::Float32)
+                {
+                    continue;
+                }
+                const auto raw = std::bit_cast<std::uint32_t>(static_cast<float>(value_of(i) / field.scale));
+                const auto hi = static_cast<std::uint16_t>(raw >> 16);
+                const auto lo = static_cast<std::uint16_t>(raw & 0xFFFFu);
+                block[field.offset] = field.order == WordOrder::HighFirst ? hi : lo;
+                block[field.offset + 1] = field.order == WordOrder::HighFirst ? lo : hi;
+            }
+        }
+
+        /** @brief Pack current: slow charge/discharge swing with a short load pulse every minute. */
+        double pack_current_a(double t)
+        {
+            const double swing = 20.0 * std::sin(kTwoPi * t / 300.0);
+            const double pulse = std::fmod(t, 60.0) < 5.0 ? -40.0 : 0.0;
+            return swing + pulse;
+        }
+    } // namespace
+
+    const char *to_string(DeviceProfile profile) noexcept
+    {
+        switch (profile)
+        {
+        case DeviceProfile::VoltageBoardA:
+            return "voltage-a";
+        case DeviceProfile::VoltageBoardB:
+            return "voltage-b";
+        case DeviceProfile::Temperature:
+            return "temperature";
+        }
+        return "unknown";
+    }
+
+    // ============================================================================
+    // Latency model and fault script
+    // ============================================================================
+
+    std::optional<LatencyModel> LatencyModel::parse(std::string_view spec)
+    {
+        std::vector<std::string_view> parts;
+        while (true)
+        {
+            const auto colon = spec.find(':');
+            parts.push_back(spec.substr(0, colon));
+            if (colon == std::string_view::npos)
+            {
+                break;
+            }
+            spec.remove_prefix(colon + 1);
+        }
+
+        LatencyModel model;
+        std::size_t arity = 0;
+        if (parts[0] == "const")
+        {
+            model.kind = Kind::Constant;
+            arity = 1;
+        }
+        else if (parts[0] == "uniform")
+        {
+            model.kind = Kind::Uniform;
+            arity = 2;
+        }
+        else if (parts[0] == "normal")
+        {
+            model.kind = Kind::Normal;
+            arity = 2;
+        }
+        else if (parts[0] == "lognormal")
+        {
+            model.kind = Kind::LogNormal;
+            arity = 2;
+        }
+        else
+        {
+            return std::nullopt;
+        }
+
+        if (parts.size() != arity + 1 ||
+            !parse_double(parts[1], model.a) ||
+            (arity == 2 && !parse_double(parts[2], model.b)) ||
+            model.a < 0.0 || model.b < 0.0)
+        {
+            return std::nullopt;
+        }
+        if (model.kind == Kind::Uniform && model.b < model.a)
+        {
+            return std::nullopt;
+        }
+        return model;
+    }
+
+    std::chrono::microseconds LatencyModel::sample(std::mt19937_64 &rng) const
+    {
+        double ms = 0.0;
+        switch (kind)
+        {
+        case Kind::Constant:
+            ms = a;
+            break;
+        case Kind::Uniform:
+            ms = std::uniform_real_distribution<double>(a, b)(rng);
+            break;
+        case Kind::Normal:
+            ms = std::normal_distribution<double>(a, b)(rng);
+            break;
+        case Kind::LogNormal:
+            ms = a > 0.0 ? std::lognormal_distribution<double>(std::log(a), b)(rng) : 0.0;
+            break;
+        }
+        return std::chrono::microseconds(static_cast<std::int64_t>(std::max(0.0, ms) * 1000.0));
+    }
+
+    std::optional<std::vector<FaultScriptStep>> parse_fault_script(std::string_view text, std::string &error)
+    {
+        std::vector<FaultScriptStep> steps;
+        std::istringstream lines{std::string(text)};
+        std::string line;
+        int line_no = 0;
+        while (std::getline(lines, line))
+        {
+            ++line_no;
+            line = line.substr(0, line.find('#'));
+
+            std::istringstream tokens(line);
+            std::string token;
+            if (!(tokens >> token))
+            {
+                continue;
+            }
+
+            const auto fail = [&](const std::string &what) {
+                error = "line " + std::to_string(line_no) + ": " + what;
+                return std::nullopt;
+            };
+
+            FaultScriptStep step;
+            if (!parse_double(token, step.at_s) || step.at_s < 0.0)
+            {
+                return fail("bad time '" + token + "'");
+            }
+
+            while (tokens >> token)
+            {
+                const auto eq = token.find('=');
+                if (eq == std::string::npos)
+                {
+                    return fail("expected key=value, got '" + token + "'");
+                }
+                const std::string key = token.substr(0, eq);
+                const std::string value = token.substr(eq + 1);
+
+                double number = 0.0;
+                if (key == "latency")
+                {
+                    step.latency = LatencyModel::parse(value);
+                    if (!step.latency)
+                    {
+                        return fail("bad latency '" + value + "'");
+                    }
+                    continue;
+                }
+                if (!parse_double(value, number) || number < 0.0)
+                {
+                    return fail("bad value for " + key);
+                }
+                if (key == "drop")
+                {
+                    step.drop_probability = number;
+                }
+                else if (key == "reset")
+                {
+                    step.reset_probability = number;
+                }
+                else if (key == "stall")
+                {
+                    step.stall_probability = number;
+                }
+                else if (key == "stall_ms")
+                {
+                    step.stall_ms = static_cast<int>(number);
+                }
+                else if (key == "outage")
+                {
+                    step.outage_s = number;
+                }
+                else
+                {
+                    return fail("unknown key '" + key + "'");
+                }
+            }
+            steps.push_back(std::move(step));
+        }
+
+        std::stable_sort(steps.begin(), steps.end(),
+                         [](const FaultScriptStep &l, const FaultScriptStep &r) { return l.at_s < r.at_s; });
+        return steps;
+    }
+
+    // ============================================================================
+    // DeviceSimulator
+    // ============================================================================
+
+    DeviceSimulator::DeviceSimulator(SimDeviceConfig cfg)
+        : cfg_(std::move(cfg)), faults_(cfg_.faults), rng_(cfg_.seed)
+    {
+    }
+
+    DeviceSimulator::~DeviceSimulator()
+    {
+        stop();
+    }
+
+    bool DeviceSimulator::start()
+    {
+        modbus_t *ctx = modbus_new_tcp(cfg_.bind_address.c_str(), cfg_.port);
+        if (!ctx)
+        {
+            std::cerr << "[Sim] " << to_string(cfg_.profile) << ": modbus_new_tcp failed: "
+                      << modbus_strerror(errno) << std::endl;
+            return false;
+        }
+        modbus_set_slave(ctx, cfg_.unit_id);
+
+        modbus_mapping_t *mapping = modbus_mapping_new_start_address(
+            0, 0,
+            0, 0,
+            kRtcRegister, kRtcRegisterCount,
+            kModbusStartAddr, kRegisterBlockCount);
+        if (!mapping)
+        {
+            std::cerr << "[Sim] " << to_string(cfg_.profile) << ": mapping allocation failed" << std::endl;
+            modbus_free(ctx);
+            return false;
+        }
+
+        listen_fd_ = modbus_tcp_listen(ctx, 4);
+        if (listen_fd_ < 0)
+        {
+            std::cerr << "[Sim] " << to_string(cfg_.profile) << ": cannot listen on "
+                      << cfg_.bind_address << ":" << cfg_.port << ": " << modbus_strerror(errno) << std::endl;
+            modbus_mapping_free(mapping);
+            modbus_free(ctx);
+            return false;
+        }
+
+        ctx_ = ctx;
+        mapping_ = mapping;
+        started_ = std::chrono::steady_clock::now();
+        rtc_anchor_ = clock::now();
+        rtc_offset_s_ = cfg_.clock_offset_ms * 1e-3;
+        stop_.store(false);
+        thread_ = boost::thread(&DeviceSimulator::serve_loop_, this);
+        return true;
+    }
+
+    void DeviceSimulator::stop()
+    {
+        stop_.store(true);
+        if (thread_.joinable())
+        {
+            thread_.join();
+        }
+        if (listen_fd_ >= 0)
+        {
+            ::close(listen_fd_);
+            listen_fd_ = -1;
+        }
+        if (mapping_)
+        {
+            modbus_mapping_free(as_mapping(mapping_));
+            mapping_ = nullptr;
+        }
+        if (ctx_)
+        {
+            modbus_free(as_modbus(ctx_));
+            ctx_ = nullptr;
+        }
+    }
+
+    void DeviceSimulator::set_faults(const FaultProfile &faults)
+    {
+        std::lock_guard<std::mutex> lock(faults_mutex_);
+        faults_ = faults;
+    }
+
+    FaultProfile DeviceSimulator::faults() const
+    {
+        std::lock_guard<std::mutex> lock(faults_mutex_);
+        return faults_;
+    }
+
+    void DeviceSimulator::begin_outage(std::chrono::milliseconds duration)
+    {
+        outage_until_ms_.store(steady_ms() + duration.count());
+    }
+
+    DeviceSimulator::clock::time_point DeviceSimulator::device_time_(clock::time_point now) const
+    {
+        const double elapsed = std::chrono::duration<double>(now - rtc_anchor_).count();
+        const double error_s = rtc_offset_s_ + cfg_.clock_drift_ppm * 1e-6 * elapsed;
+        return now + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(error_s));
+    }
+
+    void DeviceSimulator::refresh_registers_(clock::time_point now)
+    {
+        std::uint16_t *block = as_mapping(mapping_)->tab_input_registers;
+        const double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - started_).count();
+
+        // Registers 3..5: device RTC as epoch2000 seconds (hi, lo) + milliseconds.
+        const auto since_2000 = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                    device_time_(now) - clock::from_time_t(kUnixEpoch2000))
+                                    .count();
+        const auto seconds = static_cast<std::uint32_t>(std::max<std::int64_t>(0, since_2000 / 1000));
+        block[0] = static_cast<std::uint16_t>(seconds >> 16);
+        block[1] = static_cast<std::uint16_t>(seconds & 0xFFFFu);
+        block[2] = static_cast<std::uint16_t>(std::max<std::int64_t>(0, since_2000 % 1000));
+
+        std::normal_distribution<double> noise(0.0, 1.0);
+        const double current = pack_current_a(t);
+
+        // Open-circuit voltage follows a slow state-of-charge cycle; IR drop tracks current.
+        const auto cell_voltage = [&](std::size_t cell) {
+            const double ocv = 3.30 + 0.08 * std::sin(kTwoPi * t / 3600.0) + 0.002 * static_cast<double>(cell);
+            return ocv + 0.0015 * current + 0.001 * cfg_.noise_scale * noise(rng_);
+        };
+
+        switch (cfg_.profile)
+        {
+        case DeviceProfile::VoltageBoardA:
+            encode_map<VoltageBoardAMap>(block, [&](std::size_t i) { return cell_voltage(i); });
+            break;
+        case DeviceProfile::VoltageBoardB:
+            encode_map<VoltageBoardBMap>(block, [&](std::size_t i) {
+                // Channel 7 is the current sensor (1 A/V, the runtime's default scale).
+                return i < VoltageBoardBMap::kCellCount
+                           ? cell_voltage(VoltageBoardAMap::kCellCount + i)
+                           : current + 0.05 * cfg_.noise_scale * noise(rng_);
+            });
+            break;
+        case DeviceProfile::Temperature:
+            encode_map<TemperatureBoardMap>(block, [&](std::size_t i) {
+                const double heating = 0.02 * std::abs(current);
+                return 25.0 + 0.3 * static_cast<double>(i) + heating +
+                       2.0 * std::sin(kTwoPi * t / 1800.0) + 0.05 * cfg_.noise_scale * noise(rng_);
+            });
+            break;
+        }
+    }
+
+    void DeviceSimulator::apply_rtc_write_(bool with_millis)
+    {
+        const std::uint16_t *regs = as_mapping(mapping_)->tab_registers;
+        const std::uint32_t seconds = (static_cast<std::uint32_t>(regs[0]) << 16) | regs[1];
+        // A seconds-only write restarts the second, as the boards do.
+        const std::uint16_t millis = with_millis ? std::min<std::uint16_t>(regs[2], 999) : 0;
+
+        const auto now = clock::now();
+        const auto set_to = clock::from_time_t(kUnixEpoch2000) + std::chrono::seconds(seconds) +
+                            std::chrono::milliseconds(millis);
+        rtc_anchor_ = now;
+        rtc_offset_s_ = std::chrono::duration<double>(set_to - now).count();
+        stats_.rtc_writes.fetch_add(1);
+
+        std::cout << "[Sim] " << to_string(cfg_.profile) << ": RTC set, error now "
+                  << std::lround(rtc_offset_s_ * 1e3) << " ms" << std::endl;
+    }
+
+    void DeviceSimulator::handle_request_(int fd, std::vector<int> &clients)
+    {
+        modbus_t *ctx = as_modbus(ctx_);
+        std::uint8_t query[MODBUS_TCP_MAX_ADU_LENGTH];
+
+        modbus_set_socket(ctx, fd);
+        const int length = modbus_receive(ctx, query);
+        if (length <= 0)
+        {
+            if (length < 0)
+            {
+                // Peer closed or sent garbage: drop the connection.
+                ::close(fd);
+                clients.erase(std::find(clients.begin(), clients.end(), fd));
+            }
+            return;
+        }
+        stats_.requests.fetch_add(1);
+
+        const FaultProfile faults = this->faults();
+        const auto now_steady = std::chrono::steady_clock::now();
+        std::uniform_real_distribution<double> coin(0.0, 1.0);
+
+        if (now_steady < stalled_until_)
+        {
+            stats_.dropped.fetch_add(1);
+            return;
+        }
+        if (coin(rng_) < faults.stall_probability)
+        {
+            stalled_until_ = now_steady + std::chrono::milliseconds(faults.stall_ms);
+            stats_.stalls.fetch_add(1);
+            stats_.dropped.fetch_add(1);
+            return;
+        }
+        if (coin(rng_) < faults.drop_probability)
+        {
+            stats_.dropped.fetch_add(1);
+            return;
+        }
+        if (coin(rng_) < faults.reset_probability)
+        {
+            // Zero linger turns close() into an RST, like a rebooting board.
+            const linger abort{1, 0};
+            ::setsockopt(fd, SOL_SOCKET, SO_LINGER, &abort, sizeof(abort));
+            ::close(fd);
+            clients.erase(std::find(clients.begin(), clients.end(), fd));
+            stats_.resets.fetch_add(1);
+            return;
+        }
+
+        const auto delay = faults.latency.sample(rng_);
+        if (delay.count() > 0)
+        {
+            boost::this_thread::sleep_for(boost::chrono::microseconds(delay.count()));
+        }
+
+        // Sample the waveforms as late as possible so the RTC stamp matches the reply.
+        refresh_registers_(clock::now());
+
+        const int header = modbus_get_header_length(ctx);
+        const std::uint8_t function = query[header];
+        const int address = (query[header + 1] << 8) | query[header + 2];
+        const int count = function == MODBUS_FC_WRITE_MULTIPLE_REGISTERS
+                              ? (query[header + 3] << 8) | query[header + 4]
+                              : 1;
+
+        if (modbus_reply(ctx, query, length, as_mapping(mapping_)) < 0)
+        {
+            ::close(fd);
+            clients.erase(std::find(clients.begin(), clients.end(), fd));
+            return;
+        }
+        stats_.replies.fetch_add(1);
+
+        // Only a write of both epoch words in one request sets the clock; a single word
+        // would combine with a stale half of the other.
+        const bool rtc_write = function == MODBUS_FC_WRITE_MULTIPLE_REGISTERS &&
+                               address <= kRtcRegister && address + count >= kRtcRegister + 2;
+        if (rtc_write)
+        {
+            apply_rtc_write_(address + count >= kRtcRegister + kRtcRegisterCount);
+        }
+    }
+
+    void DeviceSimulator::serve_loop_()
+    {
+        std::vector<int> clients;
+        std::vector<pollfd> fds;
+
+        while (!stop_.load())
+        {
+            // Outage: drop every session and refuse new ones until it ends.
+            const bool outage = steady_ms() < outage_until_ms_.load();
+            if (outage && !clients.empty())
+            {
+                for (const int fd : clients)
+                {
+                    ::close(fd);
+                }
+                clients.clear();
+            }
+
+            fds.clear();
+            fds.push_back(pollfd{listen_fd_, POLLIN, 0});
+            for (const int fd : clients)
+            {
+                fds.push_back(pollfd{fd, POLLIN, 0});
+            }
+
+            const int ready = ::poll(fds.data(), fds.size(), 100);
+            if (ready <= 0)
+            {
+                continue;
+            }
+
+            if (fds[0].revents & POLLIN)
+            {
+                const int fd = ::accept(listen_fd_, nullptr, nullptr);
+                if (fd >= 0)
+                {
+                    if (outage)
+                    {
+                        ::close(fd);
+                        stats_.refused.fetch_add(1);
+                    }
+                    else
+                    {
+                        clients.push_back(fd);
+                        stats_.connections.fetch_add(1);
+                    }
+                }
+            }
+
+            for (std::size_t i = 1; i < fds.size(); ++i)
+            {
+                if (fds[i].revents & (POLLIN | POLLHUP | POLLERR))
+                {
+                    handle_request_(fds[i].fd, clients);
+                }
+            }
+        }
+
+        for (const int fd : clients)
+        {
+            ::close(fd);
+        }
+    }
+
+} // namespace bms::sim
@@ -0,0 +1,325 @@
+/**
+ * @file        sim_main.cpp
+ * @brief       Command-line entry point for the local MODBUS/TCP device simulator.
+ */
+
+#include "device_simulator.hpp"
+
+#include <boost/atomic.hpp>
+#include <boost/chrono.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    boost::atomic<bool> g_running{true};
+
+    void signal_handler(int)
+    {
+        g_running = false;
+    }
+
+    void print_usage(const char *argv0)
+    {
+        std::cout
+            << "Usage: " << argv0 << " [options]\n"
+            << "\n"
+            << "Serves the two voltage boards and the temperature board of the BMS on localhost.\n"
+            << "Point the runtime at it with:\n"
+            << "  BMS_VC1_HOST=127.0.0.1 BMS_VC1_PORT=1502 BMS_VC2_HOST=127.0.0.1 BMS_VC2_PORT=1503 \\\n"
+            << "  BMS_TEMP_HOST=127.0.0.1 BMS_TEMP_PORT=1504 ./bin/bms\n"
+            << "\n"
+            << "Endpoints:\n"
+            << "  --bind ADDR             Listen address (default 127.0.0.1)\n"
+            << "  --voltage-a PORT        Voltage board A, unit 1 (default 1502, 0 disables)\n"
+            << "  --voltage-b PORT        Voltage board B, unit 2 (default 1503, 0 disables)\n"
+            << "  --temperature PORT      Temperature board, unit 3 (default 1504, 0 disables)\n"
+            << "\n"
+            << "Device behaviour:\n"
+            << "  --clock-offset-ms MS    Initial RTC error of every board (default 0)\n"
+            << "  --clock-drift-ppm PPM   RTC rate error; board B runs at -PPM (default 0)\n"
+            << "  --noise SCALE           Waveform noise multiplier (default 1)\n"
+            << "  --seed N                RNG seed (default 1)\n"
+            << "\n"
+            << "Fault injection (applies to every board):\n"
+            << "  --latency SPEC          const:MS | uniform:LO:HI | normal:MEAN:SD | lognormal:MEDIAN:SIGMA\n"
+            << "  --drop P                Probability of swallowing a request\n"
+            << "  --reset P               Probability of aborting the connection with RST\n"
+            << "  --stall P               Probability of hanging for --stall-ms\n"
+            << "  --stall-ms MS           Stall duration (default 3000)\n"
+            << "  --script FILE           Timed profile changes, one per line:\n"
+            << "                            <seconds> [latency=SPEC] [drop=P] [reset=P] [stall=P]\n"
+            << "                                      [stall_ms=MS] [outage=SECONDS]\n"
+            << "\n"
+            << "  --stats-every S         Print per-device counters every S seconds (default 10, 0 = off)\n"
+            << std::endl;
+    }
+
+    bool read_file(const std::string &path, std::string &out)
+    {
+        std::ifstream in(path);
+        if (!in)
+        {
+            return false;
+        }
+        std::ostringstream buffer;
+        buffer << in.rdbuf();
+        out = buffer.str();
+        return true;
+    }
+
+    void print_stats(const bms::sim::DeviceSimulator &device)
+    {
+        const auto &s = device.stats();
+        std::cout << "[Sim][" << bms::sim::to_string(device.config().profile) << "]"
+                  << " conns=" << s.connections.load()
+                  << " req=" << s.requests.load()
+                  << " replies=" << s.replies.load()
+                  << " dropped=" << s.dropped.load()
+                  << " resets=" << s.resets.load()
+                  << " stalls=" << s.stalls.load()
+                  << " refused=" << s.refused.load()
+                  << " rtc_writes=" << s.rtc_writes.load()
+                  << std::endl;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::signal(SIGINT, signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
+    std::string bind_address = "127.0.0.1";
+    int port_a = 1502;
+    int port_b = 1503;
+    int port_t = 1504;
+    double clock_offset_ms = 0.0;
+    double clock_drift_ppm = 0.0;
+    double noise = 1.0;
+    std::uint64_t seed = 1;
+    int stats_every_s = 10;
+    bms::sim::FaultProfile faults;
+    std::vector<bms::sim::FaultScriptStep> script;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help")
+        {
+            print_usage(argv[0]);
+            return 0;
+        }
+        if (i + 1 >= argc)
+        {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return 2;
+        }
+
+        const std::string value = argv[++i];
+        try
+        {
+            if (arg == "--bind")
+            {
+                bind_address = value;
+            }
+            else if (arg == "--voltage-a")
+            {
+                port_a = std::stoi(value);
+            }
+            else if (arg == "--voltage-b")
+            {
+                port_b = std::stoi(value);
+            }
+            else if (arg == "--temperature")
+            {
+                port_t = std::stoi(value);
+            }
+            else if (arg == "--clock-offset-ms")
+            {
+                clock_offset_ms = std::stod(value);
+            }
+            else if (arg == "--clock-drift-ppm")
+            {
+                clock_drift_ppm = std::stod(value);
+            }
+            else if (arg == "--noise")
+            {
+                noise = std::stod(value);
+            }
+            else if (arg == "--seed")
+            {
+                seed = std::stoull(value);
+            }
+            else if (arg == "--stats-every")
+            {
+                stats_every_s = std::stoi(value);
+            }
+            else if (arg == "--drop")
+            {
+                faults.drop_probability = std::stod(value);
+            }
+            else if (arg == "--reset")
+            {
+                faults.reset_probability = std::stod(value);
+            }
+            else if (arg == "--stall")
+            {
+                faults.stall_probability = std::stod(value);
+            }
+            else if (arg == "--stall-ms")
+            {
+                faults.stall_ms = std::stoi(value);
+            }
+            else if (arg == "--latency")
+            {
+                const auto model = bms::sim::LatencyModel::parse(value);
+                if (!model)
+                {
+                    std::cerr << "Invalid latency spec: " << value << std::endl;
+                    return 2;
+                }
+                faults.latency = *model;
+            }
+            else if (arg == "--script")
+            {
+                std::string text;
+                std::string error;
+                if (!read_file(value, text))
+                {
+                    std::cerr << "Cannot read script " << value << std::endl;
+                    return 2;
+                }
+                auto parsed = bms::sim::parse_fault_script(text, error);
+                if (!parsed)
+                {
+                    std::cerr << value << ": " << error << std::endl;
+                    return 2;
+                }
+                script = std::move(*parsed);
+            }
+            else
+            {
+                std::cerr << "Unknown option " << arg << " (see --help)" << std::endl;
+                return 2;
+            }
+        }
+        catch (const std::exception &)
+        {
+            std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+            return 2;
+        }
+    }
+
+    // One server per enabled board; unit IDs match the runtime's defaults.
+    std::vector<std::unique_ptr<bms::sim::DeviceSimulator>> devices;
+    const auto add_device = [&](bms::sim::DeviceProfile profile, int port, int unit_id, double drift_ppm) {
+        if (port <= 0)
+        {
+            return true;
+        }
+        bms::sim::SimDeviceConfig cfg;
+        cfg.profile = profile;
+        cfg.bind_address = bind_address;
+        cfg.port = port;
+        cfg.unit_id = unit_id;
+        cfg.clock_offset_ms = clock_offset_ms;
+        cfg.clock_drift_ppm = drift_ppm;
+        cfg.noise_scale = noise;
+        cfg.faults = faults;
+        cfg.seed = seed + static_cast<std::uint64_t>(unit_id);
+
+        auto device = std::make_unique<bms::sim::DeviceSimulator>(cfg);
+        if (!device->start())
+        {
+            return false;
+        }
+        std::cout << "[Sim] " << bms::sim::to_string(profile) << " unit " << unit_id
+                  << " listening on " << bind_address << ":" << port << std::endl;
+        devices.push_back(std::move(device));
+        return true;
+    };
+
+    // Opposite drift on the two voltage boards makes inter-device skew visible.
+    if (!add_device(bms::sim::DeviceProfile::VoltageBoardA, port_a, 1, clock_drift_ppm) ||
+        !add_device(bms::sim::DeviceProfile::VoltageBoardB, port_b, 2, -clock_drift_ppm) ||
+        !add_device(bms::sim::DeviceProfile::Temperature, port_t, 3, clock_drift_ppm))
+    {
+        return 1;
+    }
+
+    const auto started = boost::chrono::steady_clock::now();
+    std::size_t next_step = 0;
+    int seconds = 0;
+    auto next_stats = started + boost::chrono::seconds(stats_every_s);
+
+    while (g_running)
+    {
+        boost::this_thread::sleep_for(boost::chrono::milliseconds(50));
+        const auto now = boost::chrono::steady_clock::now();
+        const double elapsed_s = boost::chrono::duration<double>(now - started).count();
+
+        // Apply every script step that has come due.
+        while (next_step < script.size() && script[next_step].at_s <= elapsed_s)
+        {
+            const auto &step = script[next_step++];
+            for (auto &device : devices)
+            {
+                bms::sim::FaultProfile updated = device->faults();
+                if (step.latency)
+                {
+                    updated.latency = *step.latency;
+                }
+                if (step.drop_probability)
+                {
+                    updated.drop_probability = *step.drop_probability;
+                }
+                if (step.reset_probability)
+                {
+                    updated.reset_probability = *step.reset_probability;
+                }
+                if (step.stall_probability)
+                {
+                    updated.stall_probability = *step.stall_probability;
+                }
+                if (step.stall_ms)
+                {
+                    updated.stall_ms = *step.stall_ms;
+                }
+                device->set_faults(updated);
+
+                if (step.outage_s)
+                {
+                    device->begin_outage(std::chrono::milliseconds(static_cast<std::int64_t>(*step.outage_s * 1000.0)));
+                }
+            }
+            std::cout << "[Sim] t=" << step.at_s << "s applied script step " << next_step << std::endl;
+        }
+
+        if (stats_every_s > 0 && now >= next_stats)
+        {
+            next_stats += boost::chrono::seconds(stats_every_s);
+            seconds += stats_every_s;
+            std::cout << "[Sim] t=" << seconds << "s" << std::endl;
+            for (const auto &device : devices)
+            {
+                print_stats(*device);
+            }
+        }
+    }
+
+    std::cout << "[Sim] Shutting down..." << std::endl;
+    for (auto &device : devices)
+    {
+        device->stop();
+        print_stats(*device);
+    }
+    return 0;
+}
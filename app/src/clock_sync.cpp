@@ -0,0 +1,247 @@
+/**
+ * @file clock_sync.cpp
+ * @brief Device clock offset/drift estimator implementation.
+ */
+
+#include "clock_sync.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace bms
+{
+    ClockOffsetEstimator::ClockOffsetEstimator(ClockEstimatorConfig cfg) noexcept
+        : cfg_(std::move(cfg))
+    {
+    }
+
+    double ClockOffsetEstimator::seconds_since_ref_(clock::time_point tp) const noexcept
+    {
+        return std::chrono::duration<double>(tp - ref_).count();
+    }
+
+    double ClockOffsetEstimator::device_seconds_(const DeviceTimestamp &device) const noexcept
+    {
+        // The ms register truncates: the true instant lies on average half a tick later.
+        return seconds_since_ref_(device.timestamp) + 0.5e-3 * cfg_.resolution_ms;
+    }
+
+    double ClockOffsetEstimator::offset_at_(double t) const noexcept
+    {
+        return offset0_ + drift_ * (t - t0_);
+    }
+
+    bool ClockOffsetEstimator::update(const DeviceTimestamp &device,
+                                      clock::time_point sent,
+                                      clock::time_point received) noexcept
+    {
+        if (!device.valid || received < sent)
+        {
+            rejected_++;
+            return false;
+        }
+
+        if (!has_ref_)
+        {
+            ref_ = sent;
+            has_ref_ = true;
+        }
+
+        Exchange ex;
+        ex.t = seconds_since_ref_(sent) + 0.5 * std::chrono::duration<double>(received - sent).count();
+        ex.half_rtt = 0.5 * std::chrono::duration<double>(received - sent).count();
+        ex.offset = device_seconds_(device) - ex.t;
+
+        // Reject exchanges that disagree with the established fit beyond their error bound.
+        if (valid())
+        {
+            const double residual = std::abs(ex.offset - offset_at_(ex.t));
+            const double limit = std::max(cfg_.outlier_factor * (uncertainty_ + ex.half_rtt),
+                                          cfg_.outlier_floor_ms * 1e-3);
+            if (residual > limit)
+            {
+                rejected_++;
+                if (++consecutive_outliers_ < cfg_.max_consecutive_outliers)
+                {
+                    return false;
+                }
+
+                // Persistent disagreement: the device clock was stepped, start over.
+                reset();
+                ref_ = sent;
+                has_ref_ = true;
+                ex.t = 0.5 * std::chrono::duration<double>(received - sent).count();
+                ex.offset = device_seconds_(device) - ex.t;
+            }
+        }
+        consecutive_outliers_ = 0;
+
+        // Close the slot once it has elapsed; within a slot keep the lowest-delay exchange.
+        if (has_pending_ && ex.t - slot_start_ >= cfg_.slot_s)
+        {
+            window_[head_] = pending_;
+            head_ = (head_ + 1) % kWindow;
+            size_ = std::min(size_ + 1, kWindow);
+            has_pending_ = false;
+        }
+        if (!has_pending_)
+        {
+            pending_ = ex;
+            slot_start_ = ex.t;
+            has_pending_ = true;
+        }
+        else if (ex.half_rtt < pending_.half_rtt)
+        {
+            pending_ = ex;
+        }
+        accepted_++;
+        accepted_since_reset_++;
+
+        refit_();
+        return true;
+    }
+
+    HostTimestamp ClockOffsetEstimator::stamp(const DeviceTimestamp &device,
+                                              clock::time_point sent,
+                                              clock::time_point received) noexcept
+    {
+        const bool accepted = update(device, sent, received);
+
+        HostTimestamp out;
+        if (accepted && valid())
+        {
+            out.time = to_host_time(device);
+            out.uncertainty_us = uncertainty_us();
+            out.from_device_clock = true;
+            return out;
+        }
+
+        const auto half_rtt = (received - sent) / 2;
+        out.time = sent + half_rtt;
+        out.uncertainty_us = std::chrono::duration_cast<std::chrono::microseconds>(half_rtt).count();
+        return out;
+    }
+
+    template <typename Fn>
+    void ClockOffsetEstimator::for_each_filtered_(double cutoff, Fn &&fn) const
+    {
+        for (std::size_t i = 0; i < size_; ++i)
+        {
+            if (window_[i].half_rtt <= cutoff)
+            {
+                fn(window_[i]);
+            }
+        }
+        if (has_pending_ && pending_.half_rtt <= cutoff)
+        {
+            fn(pending_);
+        }
+    }
+
+    void ClockOffsetEstimator::refit_() noexcept
+    {
+        // Clock filter: only exchanges with near-minimal delay carry a tight offset bound.
+        double min_half_rtt = pending_.half_rtt;
+        for (std::size_t i = 0; i < size_; ++i)
+        {
+            min_half_rtt = std::min(min_half_rtt, window_[i].half_rtt);
+        }
+        const double resolution = cfg_.resolution_ms * 1e-3;
+        const double cutoff = 2.0 * min_half_rtt + resolution;
+        const auto weight = [resolution](const Exchange &ex) {
+            const double bound = ex.half_rtt + resolution;
+            return 1.0 / (bound * bound);
+        };
+
+        // Weighted least squares, weight = 1 / bound^2.
+        double sw = 0.0;
+        double st = 0.0;
+        double so = 0.0;
+        double t_min = pending_.t;
+        double t_max = pending_.t;
+        for_each_filtered_(cutoff, [&](const Exchange &ex) {
+            const double w = weight(ex);
+            sw += w;
+            st += w * ex.t;
+            so += w * ex.offset;
+            t_min = std::min(t_min, ex.t);
+            t_max = std::max(t_max, ex.t);
+        });
+
+        const double t_mean = st / sw;
+        const double o_mean = so / sw;
+
+        double stt = 0.0;
+        double sto = 0.0;
+        for_each_filtered_(cutoff, [&](const Exchange &ex) {
+            const double w = weight(ex);
+            stt += w * (ex.t - t_mean) * (ex.t - t_mean);
+            sto += w * (ex.t - t_mean) * (ex.offset - o_mean);
+        });
+
+        // Drift is only observable once the filtered samples span enough time.
+        if (t_max - t_min >= cfg_.min_drift_span_s && stt > 0.0)
+        {
+            drift_ = sto / stt;
+        }
+        t0_ = t_mean;
+        offset0_ = o_mean;
+
+        double sr = 0.0;
+        for_each_filtered_(cutoff, [&](const Exchange &ex) {
+            const double r = ex.offset - offset_at_(ex.t);
+            sr += weight(ex) * r * r;
+        });
+
+        // Delay bound of the best exchange, quantization, and observed scatter.
+        uncertainty_ = min_half_rtt + resolution + std::sqrt(sr / sw);
+    }
+
+    ClockOffsetEstimator::clock::time_point ClockOffsetEstimator::to_host_time(
+        const DeviceTimestamp &device) const noexcept
+    {
+        // host = device - offset(host); offset varies by drift * offset over the gap,
+        // which is far below the resolution, so one evaluation at device time suffices.
+        const double td = device_seconds_(device);
+        const double host = td - offset_at_(td - offset0_);
+        return ref_ + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(host));
+    }
+
+    std::int64_t ClockOffsetEstimator::uncertainty_us() const noexcept
+    {
+        return static_cast<std::int64_t>(std::ceil(uncertainty_ * 1e6));
+    }
+
+    ClockEstimate ClockOffsetEstimator::estimate(clock::time_point at) const noexcept
+    {
+        ClockEstimate out;
+        out.valid = valid();
+        out.accepted = accepted_;
+        out.rejected = rejected_;
+        out.resets = resets_;
+        if (has_ref_ && has_pending_)
+        {
+            out.offset_us = static_cast<std::int64_t>(std::llround(offset_at_(seconds_since_ref_(at)) * 1e6));
+            out.drift_ppb = static_cast<std::int64_t>(std::llround(drift_ * 1e9));
+            out.uncertainty_us = uncertainty_us();
+        }
+        return out;
+    }
+
+    void ClockOffsetEstimator::reset() noexcept
+    {
+        head_ = 0;
+        size_ = 0;
+        has_pending_ = false;
+        has_ref_ = false;
+        offset0_ = 0.0;
+        drift_ = 0.0;
+        t0_ = 0.0;
+        uncertainty_ = 0.0;
+        accepted_since_reset_ = 0;
+        consecutive_outliers_ = 0;
+        resets_++;
+    }
+
+} // namespace bms
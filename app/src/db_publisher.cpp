@@ -5,8 +5,12 @@
 
 #include "db_publisher.hpp"
 
+#include <array>
 #include <charconv>
+#include <chrono>
+#include <cmath>
 #include <string>
+#include <utility>
 
 namespace bms
 {
@@ -52,6 +56,16 @@ namespace bms
             }
             out += std::to_string(value);
         }
+
+        /** @brief Writes the comma between line-protocol fields (none before the first). */
+        void append_field_separator(std::string &out, bool &first)
+        {
+            if (!first)
+            {
+                out.push_back(',');
+            }
+            first = false;
+        }
     } // namespace
 
     DBPublisherTask::DBPublisherTask(InfluxHTTPClient &client,
@@ -63,6 +77,18 @@ namespace bms
           temperature_queue_(temperature_queue),
           cfg_(cfg)
     {
+        (void)selector_.add(voltage_queue_);
+        (void)selector_.add(temperature_queue_);
+        payload_row_ns_.reserve(cfg_.max_lines_per_post);
+    }
+
+    void DBPublisherTask::attach_alarm_lane(VoltageAlarmQueue &voltage_alarms, TemperatureAlarmQueue &temperature_alarms)
+    {
+        voltage_alarms_ = &voltage_alarms;
+        temperature_alarms_ = &temperature_alarms;
+        (void)selector_.add(voltage_alarms);
+        (void)selector_.add(temperature_alarms);
+        alarm_row_ns_.reserve(voltage_alarms.capacity() + temperature_alarms.capacity());
     }
 
     void DBPublisherTask::operator()()
@@ -72,85 +98,29 @@ namespace bms
         payload.reserve(cfg_.max_payload_bytes);
 
         std::size_t lines_in_payload = 0;
-        VoltageCurrentSample *vc_ptr = nullptr;
-        TemperatureSample *temp_ptr = nullptr;
 
         while (true)
         {
-            // Prefer immediate non-blocking drains before waiting on the voltage queue.
-            if (voltage_queue_.try_pop(vc_ptr))
-            {
-            }
-            else if (temperature_queue_.try_pop(temp_ptr))
-            {
-            }
-            else
-            {
-                if (voltage_queue_.is_closed() && temperature_queue_.is_closed())
-                {
-                    break;
-                }
-                // No immediate work: flush on timer and keep the loop responsive to shutdown.
-                const bool got_voltage = voltage_queue_.wait_for_and_pop(vc_ptr, cfg_.flush_interval);
-                if (!got_voltage)
-                {
-                    const bool temp_arrived = temperature_queue_.try_pop(temp_ptr);
-                    if (temp_arrived)
-                    {
-                    }
-                    else
-                    {
-                        (void)flush_payload_(payload, false);
-                        continue;
-                    }
-                }
-            }
+            // Alarm rows skip batching: post them on their own before any bulk work.
+            (void)publish_alarms_();
 
-            // Serialize and release popped voltage sample ownership.
-            if (vc_ptr != nullptr && append_voltage_row_(payload, *vc_ptr))
-            {
-                diagnostics_.voltage_rows_written += 1;
-                lines_in_payload += 1;
-            }
-            if (vc_ptr != nullptr)
-            {
-                voltage_queue_.dispose(vc_ptr);
-                vc_ptr = nullptr;
-            }
-
-            // Serialize and release popped temperature sample ownership.
-            if (temp_ptr != nullptr && append_temperature_row_(payload, *temp_ptr))
-            {
-                diagnostics_.temperature_rows_written += 1;
-                lines_in_payload += 1;
-            }
-            if (temp_ptr != nullptr)
-            {
-                temperature_queue_.dispose(temp_ptr);
-                temp_ptr = nullptr;
-            }
-
-            // Drain backlog batches to maximize each HTTP payload.
-            while (temperature_queue_.try_pop(temp_ptr))
-            {
-                if (append_temperature_row_(payload, *temp_ptr))
-                {
-                    diagnostics_.temperature_rows_written += 1;
-                    lines_in_payload += 1;
-                }
-                temperature_queue_.dispose(temp_ptr);
-                temp_ptr = nullptr;
-            }
+            // Drain backlog in bulk batches to maximize each HTTP payload.
+            std::size_t drained = drain_temperature_(payload, lines_in_payload);
+            drained += drain_voltage_(payload, lines_in_payload);
 
-            while (voltage_queue_.try_pop(vc_ptr))
+            if (drained == 0)
             {
-                if (append_voltage_row_(payload, *vc_ptr))
+                // No immediate work: sleep until either queue has data, flush on timer and
+                // stay responsive to shutdown.
+                if (!selector_.wait_for(cfg_.flush_interval))
                 {
-                    diagnostics_.voltage_rows_written += 1;
-                    lines_in_payload += 1;
+                    if (selector_.all_closed())
+                    {
+                        break;
+                    }
+                    (void)flush_payload_(payload, false);
                 }
-                voltage_queue_.dispose(vc_ptr);
-                vc_ptr = nullptr;
+                continue;
             }
 
             // Trigger threshold-based flush when line count or payload bytes exceed limits.
@@ -167,42 +137,99 @@ namespace bms
             }
         }
 
-        // After queue closure, drain remaining temperature data then perform final flush.
-        while (temperature_queue_.try_pop(temp_ptr))
+        // After queue closure, drain remaining data then perform final flush.
+        (void)publish_alarms_();
+        (void)drain_temperature_(payload, lines_in_payload);
+        (void)drain_voltage_(payload, lines_in_payload);
+
+        (void)flush_payload_(payload, false);
+    }
+
+    std::size_t DBPublisherTask::drain_voltage_(std::string &payload, std::size_t &lines_in_payload)
+    {
+        std::array<VoltageCurrentSample *, kDrainBatch> batch{};
+        std::size_t total = 0;
+        std::size_t n = 0;
+        do
         {
-            if (append_temperature_row_(payload, *temp_ptr))
+            n = voltage_queue_.pop_bulk(batch);
+            for (std::size_t i = 0; i < n; ++i)
             {
-                diagnostics_.temperature_rows_written += 1;
-                lines_in_payload += 1;
+                if (append_voltage_row_(payload, *batch[i]))
+                {
+                    diagnostics_.voltage_rows_written += 1;
+                    lines_in_payload += 1;
+                    payload_row_ns_.push_back(to_influxdb_ns(batch[i]->timestamp));
+                }
+                voltage_queue_.dispose(batch[i]);
             }
-            temperature_queue_.dispose(temp_ptr);
-            temp_ptr = nullptr;
-        }
+            total += n;
+        } while (n == batch.size());
+        return total;
+    }
 
-        (void)flush_payload_(payload, false);
+    std::size_t DBPublisherTask::drain_temperature_(std::string &payload, std::size_t &lines_in_payload)
+    {
+        std::array<TemperatureSample *, kDrainBatch> batch{};
+        std::size_t total = 0;
+        std::size_t n = 0;
+        do
+        {
+            n = temperature_queue_.pop_bulk(batch);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                if (append_temperature_row_(payload, *batch[i]))
+                {
+                    diagnostics_.temperature_rows_written += 1;
+                    lines_in_payload += 1;
+                    payload_row_ns_.push_back(to_influxdb_ns(batch[i]->timestamp));
+                }
+                temperature_queue_.dispose(batch[i]);
+            }
+            total += n;
+        } while (n == batch.size());
+        return total;
     }
 
     bool DBPublisherTask::append_voltage_row_(std::string &payload, const VoltageCurrentSample &sample)
     {
         payload += "voltage_current ";
 
+        // Line protocol has no NaN: fields of a missing device half are omitted (null).
+        bool first = true;
         for (std::size_t i = 0; i < sample.cell_voltages.size(); ++i)
         {
-            if (i > 0)
+            if (!std::isfinite(sample.cell_voltages[i]))
             {
-                payload.push_back(',');
+                continue;
             }
+            append_field_separator(payload, first);
             payload += "cell";
             append_uint64(payload, i + 1);
             payload += "_v=";
             append_float(payload, sample.cell_voltages[i]);
         }
 
-        payload += ",raw_current_sensor_v=";
-        append_float(payload, sample.raw_current_sensor_v);
-        payload += ",current_a=";
-        append_float(payload, sample.current_a);
-        payload += ",sequence=";
+        if (std::isfinite(sample.raw_current_sensor_v))
+        {
+            append_field_separator(payload, first);
+            payload += "raw_current_sensor_v=";
+            append_float(payload, sample.raw_current_sensor_v);
+        }
+        if (std::isfinite(sample.current_a))
+        {
+            append_field_separator(payload, first);
+            payload += "current_a=";
+            append_float(payload, sample.current_a);
+        }
+        append_field_separator(payload, first);
+        payload += "device_skew_us=";
+        append_int64(payload, sample.device_skew_us);
+        payload += "i,time_uncertainty_us=";
+        append_int64(payload, sample.time_uncertainty_us);
+        payload += "i,flags=";
+        append_uint64(payload, static_cast<std::uint32_t>(sample.flags));
+        payload += "u,sequence=";
         append_uint64(payload, sample.sequence);
         payload += "u ";
         append_int64(payload, to_influxdb_ns(sample.timestamp));
@@ -214,19 +241,26 @@ namespace bms
     {
         payload += "temperature ";
 
+        bool first = true;
         for (std::size_t i = 0; i < sample.temperatures.size(); ++i)
         {
-            if (i > 0)
+            if (!std::isfinite(sample.temperatures[i]))
             {
-                payload.push_back(',');
+                continue;
             }
+            append_field_separator(payload, first);
             payload += "sensor";
             append_uint64(payload, i + 1);
             payload += "_c=";
             append_float(payload, sample.temperatures[i]);
         }
 
-        payload += ",sequence=";
+        append_field_separator(payload, first);
+        payload += "time_uncertainty_us=";
+        append_int64(payload, sample.time_uncertainty_us);
+        payload += "i,flags=";
+        append_uint64(payload, static_cast<std::uint32_t>(sample.flags));
+        payload += "u,sequence=";
         append_uint64(payload, sample.sequence);
         payload += "u ";
         append_int64(payload, to_influxdb_ns(sample.timestamp));
@@ -254,8 +288,70 @@ namespace bms
         {
             diagnostics_.timer_flushes += 1;
         }
+        record_storage_latency_(storage_latency_, payload_row_ns_);
         payload.clear();
+        payload_row_ns_.clear();
         return true;
     }
 
+    std::size_t DBPublisherTask::publish_alarms_()
+    {
+        if (voltage_alarms_ == nullptr || temperature_alarms_ == nullptr)
+        {
+            return 0;
+        }
+
+        std::array<VoltageCurrentSample, kDrainBatch> vc_batch{};
+        const std::size_t vc_count = voltage_alarms_->pop_bulk(vc_batch);
+        for (std::size_t i = 0; i < vc_count; ++i)
+        {
+            if (append_voltage_row_(alarm_payload_, vc_batch[i]))
+            {
+                alarm_row_ns_.push_back(to_influxdb_ns(vc_batch[i].timestamp));
+            }
+        }
+
+        std::array<TemperatureSample, kDrainBatch> temp_batch{};
+        const std::size_t temp_count = temperature_alarms_->pop_bulk(temp_batch);
+        for (std::size_t i = 0; i < temp_count; ++i)
+        {
+            if (append_temperature_row_(alarm_payload_, temp_batch[i]))
+            {
+                alarm_row_ns_.push_back(to_influxdb_ns(temp_batch[i].timestamp));
+            }
+        }
+
+        const std::size_t rows = alarm_row_ns_.size();
+        if (rows == 0)
+        {
+            return 0;
+        }
+
+        // A failed alarm post is not retried here: the same rows also travel the bulk path.
+        std::string error;
+        if (client_.write_lp(alarm_payload_, error))
+        {
+            diagnostics_.alarm_posts += 1;
+            diagnostics_.alarm_rows_written += rows;
+            record_storage_latency_(alarm_latency_, alarm_row_ns_);
+        }
+        else
+        {
+            diagnostics_.alarm_write_failures += 1;
+            diagnostics_.last_error = std::move(error);
+        }
+        alarm_payload_.clear();
+        alarm_row_ns_.clear();
+        return rows;
+    }
+
+    void DBPublisherTask::record_storage_latency_(LatencyHistogram &histogram, const std::vector<std::int64_t> &row_ns)
+    {
+        const std::int64_t now_ns = to_influxdb_ns(std::chrono::system_clock::now());
+        for (const std::int64_t sampled_ns : row_ns)
+        {
+            histogram.record(now_ns > sampled_ns ? static_cast<std::uint64_t>(now_ns - sampled_ns) / 1000u : 0u);
+        }
+    }
+
 } // namespace bms
@@ -0,0 +1,72 @@
+/**
+ * @file event_count.cpp
+ * @brief Linux futex calls behind the eventcount slow paths.
+ */
+
+#include "event_count.hpp"
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <ctime>
+
+namespace bms
+{
+    namespace
+    {
+        static_assert(sizeof(boost::atomic<std::uint32_t>) == sizeof(std::uint32_t),
+                      "futex word must be a plain 32-bit integer");
+
+        std::uint32_t *futex_word(boost::atomic<std::uint32_t> &word) noexcept
+        {
+            return reinterpret_cast<std::uint32_t *>(&word);
+        }
+
+        // FUTEX_WAIT_BITSET takes an absolute CLOCK_MONOTONIC deadline (nullptr = forever),
+        // which is the clock behind std::chrono::steady_clock on Linux.
+        long futex_wait(std::uint32_t *addr, std::uint32_t expected, const timespec *deadline) noexcept
+        {
+            return ::syscall(SYS_futex, addr, FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG, expected,
+                             deadline, nullptr, FUTEX_BITSET_MATCH_ANY);
+        }
+    } // namespace
+
+    void EventCount::wait(key_type key) noexcept
+    {
+        // Spurious returns (EINTR) and EAGAIN are fine: the caller re-checks its condition.
+        if (epoch_.load(boost::memory_order_acquire) == key)
+        {
+            (void)futex_wait(futex_word(epoch_), key, nullptr);
+        }
+        waiters_.fetch_sub(1, boost::memory_order_relaxed);
+    }
+
+    bool EventCount::wait_until(key_type key, std::chrono::steady_clock::time_point deadline) noexcept
+    {
+        bool notified = true;
+        if (epoch_.load(boost::memory_order_acquire) == key)
+        {
+            const auto since_epoch = deadline.time_since_epoch();
+            const auto secs = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+            timespec ts{};
+            ts.tv_sec = static_cast<time_t>(secs.count());
+            ts.tv_nsec = static_cast<long>(std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch - secs).count());
+            if (futex_wait(futex_word(epoch_), key, &ts) != 0 && errno == ETIMEDOUT)
+            {
+                notified = epoch_.load(boost::memory_order_acquire) != key;
+            }
+        }
+        waiters_.fetch_sub(1, boost::memory_order_relaxed);
+        return notified;
+    }
+
+    void EventCount::wake_(int count) noexcept
+    {
+        epoch_.fetch_add(1, boost::memory_order_seq_cst);
+        (void)::syscall(SYS_futex, futex_word(epoch_), FUTEX_WAKE | FUTEX_PRIVATE_FLAG, count,
+                        nullptr, nullptr, 0);
+    }
+
+} // namespace bms
@@ -6,6 +6,9 @@
 #include "db_publisher.hpp"
 #include "influxdb.hpp"
 #include "periodic_task.hpp"
+#include "register_log.hpp"
+#include "register_replay.hpp"
+#include "sample_broadcast.hpp"
 #include "soc.hpp"
 #include "soh.hpp"
 #include "temperature.hpp"
@@ -17,9 +20,12 @@
 
 #include <csignal>
 #include <chrono>
+#include <cstddef>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <string>
 
 #include <nlohmann/json.hpp>
 
@@ -59,6 +65,90 @@ std::string get_token()
     return "";
 }
 
+/**
+ * @brief Overrides a device endpoint from @c <prefix>_HOST / @c <prefix>_PORT, if set.
+ * @details Lets the runtime run against the local simulator (bms_sim) or another bench.
+ * With @c BMS_SHARE_CONNECTIONS set, devices on the same host:port (unit IDs behind one
+ * gateway) share a single TCP connection.
+ * @param cfg Endpoint to update.
+ * @param prefix Environment variable prefix, e.g. "BMS_VC1".
+ */
+void apply_endpoint_env(bms::ModbusTcpConfig &cfg, const std::string &prefix)
+{
+    if (const char *host = std::getenv((prefix + "_HOST").c_str()))
+    {
+        cfg.host = host;
+    }
+    if (const char *port = std::getenv((prefix + "_PORT").c_str()))
+    {
+        try
+        {
+            cfg.port = std::stoi(port);
+        }
+        catch (const std::exception &)
+        {
+            std::cout << "[Main] Error: Ignoring invalid " << prefix << "_PORT=" << port << std::endl;
+        }
+    }
+    if (std::getenv("BMS_SHARE_CONNECTIONS"))
+    {
+        cfg.share_connection = true;
+    }
+}
+
+/**
+ * @brief Parses @c BMS_REPLAY_SPEED: a positive factor, or "max"/"0" for unthrottled.
+ * @return Replay speed factor; 1.0 when unset or invalid.
+ */
+double replay_speed_env()
+{
+    const char *speed = std::getenv("BMS_REPLAY_SPEED");
+    if (!speed)
+    {
+        return 1.0;
+    }
+    if (std::string(speed) == "max")
+    {
+        return 0.0;
+    }
+    try
+    {
+        const double value = std::stod(speed);
+        if (value >= 0.0)
+        {
+            return value;
+        }
+    }
+    catch (const std::exception &)
+    {
+    }
+    std::cout << "[Main] Error: Ignoring invalid BMS_REPLAY_SPEED=" << speed << std::endl;
+    return 1.0;
+}
+
+/**
+ * @brief Prints one consumer queue's fill level, per-policy overflow counters and,
+ * when tracked, how long elements waited in it.
+ */
+template <typename Queue>
+void print_queue_diagnostics(const char *label, const Queue &queue)
+{
+    std::cout << "    " << label << ": size=" << queue.approximate_size()
+              << " peak=" << queue.peak_size()
+              << " dropped=" << queue.dropped_count()
+              << " overwritten=" << queue.overwritten_count()
+              << " coalesced=" << queue.coalesced_count()
+              << " blocked=" << queue.blocked_count() << std::endl;
+    if (queue.tracks_residency())
+    {
+        const bms::LatencyPercentiles residency = queue.residency();
+        std::cout << "      residency_us: n=" << residency.count
+                  << " p50=" << residency.p50_us
+                  << " p99=" << residency.p99_us
+                  << " max=" << residency.max_us << std::endl;
+    }
+}
+
 int main()
 {
     // Install signal hooks first so every later phase can shutdown cooperatively.
@@ -69,54 +159,72 @@ int main()
     std::cout << " BMS Simplified Operational Runtime " << std::endl;
     std::cout << "========================================" << std::endl;
 
+    // Queue depths per consumer. The DB publisher shares pooled slots; SoC and SoH copy
+    // every sample anyway, so their queues hold samples inline and take no slots. Each
+    // pool covers a full DB queue, one drain batch popped by the publisher and not yet
+    // disposed, and the sample the producer is filling.
+    constexpr std::size_t kVoltageQueueDepth = 2048;
+    constexpr std::size_t kTemperatureQueueDepth = 512;
+    constexpr std::size_t kSlotHeadroom = bms::DBPublisherTask::kDrainBatch + 1;
+    constexpr std::size_t kAlarmQueueDepth = 16;
+
+    // Broadcasts are declared before the queues so they outlive the queues' final disposal.
+    // Each broadcast has one publishing thread (its acquisition task, or the replay thread)
+    // and every queue one consumer, so the queues use the single-producer ring.
+    bms::SampleBroadcast<bms::VoltageCurrentSample, bms::spsc_topology> voltage_broadcast(kVoltageQueueDepth + kSlotHeadroom);
+    bms::SampleBroadcast<bms::TemperatureSample, bms::spsc_topology> temperature_broadcast(kTemperatureQueueDepth + kSlotHeadroom);
+
     // Create one queue pair per downstream consumer to keep processing paths decoupled.
-    bms::DBPublisherTask::VoltageQueue db_voltage_queue(2048);
-    bms::DBPublisherTask::TemperatureQueue db_temperature_queue(512);
-    bms::SoCTask::VoltageQueue soc_voltage_queue(2048);
-    bms::SoCTask::TemperatureQueue soc_temperature_queue(512);
-    bms::SoHTask::VoltageQueue soh_voltage_queue(2048);
-    bms::SoHTask::TemperatureQueue soh_temperature_queue(512);
-
-    // Fan out each voltage/current sample into independent queue ownership domains.
+    // No queue uses OverflowPolicy::Block, so a stalled consumer (e.g. the DB publisher
+    // during an InfluxDB outage) never holds up the acquisition cadence:
+    //  - DB queues keep the oldest backlog and drop new samples once full;
+    //  - SoC/SoH voltage queues do the same, since the estimators integrate every sample;
+    //  - SoC/SoH temperature queues only need the most recent reading, so they coalesce.
+    bms::DBPublisherTask::VoltageQueue db_voltage_queue(kVoltageQueueDepth, voltage_broadcast.disposer(),
+                                                        bms::OverflowPolicy::DropNewest);
+    bms::DBPublisherTask::TemperatureQueue db_temperature_queue(kTemperatureQueueDepth, temperature_broadcast.disposer(),
+                                                                bms::OverflowPolicy::DropNewest);
+    bms::SoCTask::VoltageQueue soc_voltage_queue(kVoltageQueueDepth, bms::OverflowPolicy::DropNewest);
+    bms::SoCTask::TemperatureQueue soc_temperature_queue(kTemperatureQueueDepth, bms::OverflowPolicy::CoalesceLatest);
+    bms::SoHTask::VoltageQueue soh_voltage_queue(kVoltageQueueDepth, bms::OverflowPolicy::DropNewest);
+    bms::SoHTask::TemperatureQueue soh_temperature_queue(kTemperatureQueueDepth, bms::OverflowPolicy::CoalesceLatest);
+
+    // Time how long samples wait in each queue; shows which consumer adds latency under load.
+    db_voltage_queue.enable_residency_tracking();
+    db_temperature_queue.enable_residency_tracking();
+    soc_voltage_queue.enable_residency_tracking();
+    soc_temperature_queue.enable_residency_tracking();
+    soh_voltage_queue.enable_residency_tracking();
+    soh_temperature_queue.enable_residency_tracking();
+
+    // Priority lane: alarm samples are also posted on their own, ahead of bulk batching.
+    bms::DBPublisherTask::VoltageAlarmQueue voltage_alarm_queue(kAlarmQueueDepth, bms::OverflowPolicy::DropNewest);
+    bms::DBPublisherTask::TemperatureAlarmQueue temperature_alarm_queue(kAlarmQueueDepth, bms::OverflowPolicy::DropNewest);
+    const bms::AlarmLimits alarm_limits{};
+
+    voltage_broadcast.subscribe(db_voltage_queue);
+    voltage_broadcast.subscribe(soc_voltage_queue);
+    voltage_broadcast.subscribe(soh_voltage_queue);
+    temperature_broadcast.subscribe(db_temperature_queue);
+    temperature_broadcast.subscribe(soc_temperature_queue);
+    temperature_broadcast.subscribe(soh_temperature_queue);
+
+    // Each sample is written once into the DB slot and copied into the SoC/SoH rings.
+    // Alarm samples go onto the priority lane first so the publisher wakes for them at once.
     auto publish_voltage_sample = [&](const bms::VoltageCurrentSample &sample) {
-        auto *db_copy = new bms::VoltageCurrentSample(sample);
-        if (!db_voltage_queue.push_blocking(db_copy))
-        {
-            db_voltage_queue.dispose(db_copy);
-        }
-
-        auto *soc_copy = new bms::VoltageCurrentSample(sample);
-        if (!soc_voltage_queue.push_blocking(soc_copy))
-        {
-            soc_voltage_queue.dispose(soc_copy);
-        }
-
-        auto *soh_copy = new bms::VoltageCurrentSample(sample);
-        if (!soh_voltage_queue.push_blocking(soh_copy))
+        if (bms::is_voltage_alarm(sample, alarm_limits))
         {
-            soh_voltage_queue.dispose(soh_copy);
+            (void)voltage_alarm_queue.offer(sample);
         }
+        voltage_broadcast.publish(sample);
     };
 
-    // Fan out each temperature sample into independent queue ownership domains.
     auto publish_temperature_sample = [&](const bms::TemperatureSample &sample) {
-        auto *db_copy = new bms::TemperatureSample(sample);
-        if (!db_temperature_queue.push_blocking(db_copy))
-        {
-            db_temperature_queue.dispose(db_copy);
-        }
-
-        auto *soc_copy = new bms::TemperatureSample(sample);
-        if (!soc_temperature_queue.push_blocking(soc_copy))
-        {
-            soc_temperature_queue.dispose(soc_copy);
-        }
-
-        auto *soh_copy = new bms::TemperatureSample(sample);
-        if (!soh_temperature_queue.push_blocking(soh_copy))
+        if (bms::is_temperature_alarm(sample, alarm_limits))
         {
-            soh_temperature_queue.dispose(soh_copy);
+            (void)temperature_alarm_queue.offer(sample);
         }
+        temperature_broadcast.publish(sample);
     };
 
     // Build acquisition task configurations for the two MODBUS acquisition paths.
@@ -126,11 +234,15 @@ int main()
     vc_cfg.device1.unit_id = 1;
     vc_cfg.device1.connect_retries = 3;
     vc_cfg.device1.read_retries = 2;
+    vc_cfg.device1.kernel_timestamps = true;
     vc_cfg.device2.host = "192.168.7.200";
     vc_cfg.device2.port = 502;
     vc_cfg.device2.unit_id = 2;
     vc_cfg.device2.connect_retries = 3;
     vc_cfg.device2.read_retries = 2;
+    vc_cfg.device2.kernel_timestamps = true;
+    apply_endpoint_env(vc_cfg.device1, "BMS_VC1");
+    apply_endpoint_env(vc_cfg.device2, "BMS_VC2");
     vc_cfg.current_source_channel = 7;
     vc_cfg.current_scale_a_per_v = 1.0F;
     vc_cfg.current_offset_a = 0.0F;
@@ -144,6 +256,8 @@ int main()
     temp_cfg.device.unit_id = 3;
     temp_cfg.device.connect_retries = 3;
     temp_cfg.device.read_retries = 2;
+    temp_cfg.device.kernel_timestamps = true;
+    apply_endpoint_env(temp_cfg.device, "BMS_TEMP");
 
     bms::TemperatureAcquisition temperature_acquisition(temp_cfg);
     temperature_acquisition.set_sample_callback(publish_temperature_sample);
@@ -167,28 +281,66 @@ int main()
         bms::DBPublisherConfig{.max_lines_per_post = 256,
                                .max_payload_bytes = 128 * 1024,
                                .flush_interval = std::chrono::milliseconds(200)});
+    db_publisher.attach_alarm_lane(voltage_alarm_queue, temperature_alarm_queue);
 
     bms::SoCTask soc_task(bms::SoCTaskConfig{}, soc_voltage_queue, soc_temperature_queue);
     bms::SoHTask soh_task(bms::SoHTaskConfig{}, soh_voltage_queue, soh_temperature_queue);
 
-    try
+    // BMS_REPLAY feeds a register log through decode/publish instead of polling devices;
+    // BMS_RECORD logs every raw block read for later replay.
+    std::unique_ptr<bms::RegisterLogReplay> replay;
+    if (const char *path = std::getenv("BMS_REPLAY"))
     {
-        // Establish initial connectivity before worker threads start.
-        std::cout << "\n[Main] Connecting to MODBUS devices..." << std::endl;
-        const bool vc_connected = voltage_current_acquisition.connect();
-        const bool temp_connected = temperature_acquisition.connect();
+        replay = std::make_unique<bms::RegisterLogReplay>(
+            bms::RegisterReplayConfig{.path = path, .speed = replay_speed_env()},
+            &voltage_current_acquisition,
+            &temperature_acquisition);
+        if (!replay->open())
+        {
+            std::cerr << "[Main] Error: Cannot replay " << path << ": " << replay->last_error() << std::endl;
+            return 1;
+        }
+        std::cout << "[Main] Replaying " << replay->record_count() << " records from " << path << std::endl;
+    }
 
-        if (!vc_connected)
+    std::unique_ptr<bms::RegisterRecorder> recorder;
+    if (const char *path = std::getenv("BMS_RECORD"); path && !replay)
+    {
+        recorder = std::make_unique<bms::RegisterRecorder>(path);
+        if (recorder->open())
+        {
+            voltage_current_acquisition.set_recorder(recorder.get());
+            temperature_acquisition.set_recorder(recorder.get());
+            std::cout << "[Main] Recording register blocks to " << path << std::endl;
+        }
+        else
         {
-            std::cerr << "  WARNING: One or more voltage/current devices failed initial connect" << std::endl;
-            std::cerr << "    Device 1: " << voltage_current_acquisition.device1_status().last_error << std::endl;
-            std::cerr << "    Device 2: " << voltage_current_acquisition.device2_status().last_error << std::endl;
+            std::cerr << "[Main] Error: Cannot record to " << path << ": " << recorder->last_error() << std::endl;
+            recorder.reset();
         }
+    }
 
-        if (!temp_connected)
+    try
+    {
+        if (!replay)
         {
-            std::cerr << "  WARNING: Temperature device failed initial connect" << std::endl;
-            std::cerr << "    Device T: " << temperature_acquisition.device_status().last_error << std::endl;
+            // Establish initial connectivity before worker threads start.
+            std::cout << "\n[Main] Connecting to MODBUS devices..." << std::endl;
+            const bool vc_connected = voltage_current_acquisition.connect();
+            const bool temp_connected = temperature_acquisition.connect();
+
+            if (!vc_connected)
+            {
+                std::cerr << "  WARNING: One or more voltage/current devices failed initial connect" << std::endl;
+                std::cerr << "    Device 1: " << voltage_current_acquisition.device1_status().last_error << std::endl;
+                std::cerr << "    Device 2: " << voltage_current_acquisition.device2_status().last_error << std::endl;
+            }
+
+            if (!temp_connected)
+            {
+                std::cerr << "  WARNING: Temperature device failed initial connect" << std::endl;
+                std::cerr << "    Device T: " << temperature_acquisition.device_status().last_error << std::endl;
+            }
         }
 
         // Start periodic producers and long-running consumer threads.
@@ -200,8 +352,16 @@ int main()
         boost::thread soc_thread(std::ref(soc_task));
         boost::thread soh_thread(std::ref(soh_task));
 
-        voltage_current_task.start();
-        temperature_task.start();
+        boost::thread replay_thread;
+        if (replay)
+        {
+            replay_thread = boost::thread(std::ref(*replay));
+        }
+        else
+        {
+            voltage_current_task.start();
+            temperature_task.start();
+        }
 
         // Emit periodic operational diagnostics while the runtime remains active.
         int counter = 0;
@@ -209,6 +369,17 @@ int main()
         {
             boost::this_thread::sleep_for(boost::chrono::milliseconds(1000));
 
+            if (replay && replay->diagnostics().finished)
+            {
+                const auto &replay_diag = replay->diagnostics();
+                std::cout << "\n[Main] Replay finished: records=" << replay_diag.records
+                          << " vc_cycles=" << replay_diag.voltage_cycles
+                          << " temp_cycles=" << replay_diag.temperature_cycles
+                          << " unpaired=" << replay_diag.unpaired_records
+                          << " elapsed_ms=" << replay_diag.elapsed_ms << std::endl;
+                g_running = false;
+            }
+
             if (++counter % 10 == 0)
             {
                 const auto &db_diag = db_publisher.diagnostics();
@@ -219,30 +390,42 @@ int main()
                           << " temperature_rows=" << db_diag.temperature_rows_written
                           << " http_posts=" << db_diag.http_posts
                           << " write_failures=" << db_diag.write_failures << std::endl;
-                std::cout << "    db_q(vc): size=" << db_voltage_queue.approximate_size()
-                          << " peak=" << db_voltage_queue.peak_size()
-                          << " dropped=" << db_voltage_queue.dropped_count() << std::endl;
-                std::cout << "    db_q(temp): size=" << db_temperature_queue.approximate_size()
-                          << " peak=" << db_temperature_queue.peak_size()
-                          << " dropped=" << db_temperature_queue.dropped_count() << std::endl;
+                const bms::LatencyPercentiles bulk_latency = db_publisher.storage_latency();
+                const bms::LatencyPercentiles alarm_latency = db_publisher.alarm_latency();
+                std::cout << "    storage_latency_us: n=" << bulk_latency.count
+                          << " p50=" << bulk_latency.p50_us
+                          << " p99=" << bulk_latency.p99_us
+                          << " max=" << bulk_latency.max_us << std::endl;
+                std::cout << "  [AlarmLane] rows=" << db_diag.alarm_rows_written
+                          << " posts=" << db_diag.alarm_posts
+                          << " failures=" << db_diag.alarm_write_failures
+                          << " dropped=" << voltage_alarm_queue.dropped_count() + temperature_alarm_queue.dropped_count()
+                          << " latency_us: n=" << alarm_latency.count
+                          << " p50=" << alarm_latency.p50_us
+                          << " p99=" << alarm_latency.p99_us
+                          << " max=" << alarm_latency.max_us << std::endl;
+                print_queue_diagnostics("db_q(vc)", db_voltage_queue);
+                print_queue_diagnostics("db_q(temp)", db_temperature_queue);
                 std::cout << "  [SoC] frames_with_both=" << soc_diag.frames_with_both_measurements
                           << " last_vc_seq=" << soc_diag.last_voltage_sequence
                           << " last_temp_seq=" << soc_diag.last_temperature_sequence << std::endl;
-                std::cout << "    soc_q(vc): size=" << soc_voltage_queue.approximate_size()
-                          << " peak=" << soc_voltage_queue.peak_size()
-                          << " dropped=" << soc_voltage_queue.dropped_count() << std::endl;
-                std::cout << "    soc_q(temp): size=" << soc_temperature_queue.approximate_size()
-                          << " peak=" << soc_temperature_queue.peak_size()
-                          << " dropped=" << soc_temperature_queue.dropped_count() << std::endl;
+                print_queue_diagnostics("soc_q(vc)", soc_voltage_queue);
+                print_queue_diagnostics("soc_q(temp)", soc_temperature_queue);
                 std::cout << "  [SoH] frames_with_both=" << soh_diag.frames_with_both_measurements
                           << " last_vc_seq=" << soh_diag.last_voltage_sequence
                           << " last_temp_seq=" << soh_diag.last_temperature_sequence << std::endl;
-                std::cout << "    soh_q(vc): size=" << soh_voltage_queue.approximate_size()
-                          << " peak=" << soh_voltage_queue.peak_size()
-                          << " dropped=" << soh_voltage_queue.dropped_count() << std::endl;
-                std::cout << "    soh_q(temp): size=" << soh_temperature_queue.approximate_size()
-                          << " peak=" << soh_temperature_queue.peak_size()
-                          << " dropped=" << soh_temperature_queue.dropped_count() << std::endl;
+                print_queue_diagnostics("soh_q(vc)", soh_voltage_queue);
+                print_queue_diagnostics("soh_q(temp)", soh_temperature_queue);
+                const auto vc_pool = voltage_broadcast.pool().stats();
+                const auto temp_pool = temperature_broadcast.pool().stats();
+                std::cout << "  [Broadcast] vc: published=" << voltage_broadcast.published_count()
+                          << " slots=" << vc_pool.in_use << "/" << voltage_broadcast.pool().capacity()
+                          << " peak=" << vc_pool.peak_in_use
+                          << " exhausted=" << vc_pool.exhausted
+                          << " | temp: published=" << temperature_broadcast.published_count()
+                          << " slots=" << temp_pool.in_use << "/" << temperature_broadcast.pool().capacity()
+                          << " peak=" << temp_pool.peak_in_use
+                          << " exhausted=" << temp_pool.exhausted << std::endl;
             }
         }
 
@@ -251,9 +434,15 @@ int main()
 
         voltage_current_task.stop();
         temperature_task.stop();
+        if (replay)
+        {
+            replay->stop();
+        }
 
         db_voltage_queue.close();
         db_temperature_queue.close();
+        voltage_alarm_queue.close();
+        temperature_alarm_queue.close();
         soc_voltage_queue.close();
         soc_temperature_queue.close();
         soh_voltage_queue.close();
@@ -261,6 +450,10 @@ int main()
 
         voltage_current_task.join();
         temperature_task.join();
+        if (replay_thread.joinable())
+        {
+            replay_thread.join();
+        }
 
         db_publisher_thread.join();
         soc_thread.join();
@@ -268,6 +461,11 @@ int main()
 
         voltage_current_acquisition.disconnect();
         temperature_acquisition.disconnect();
+        if (recorder)
+        {
+            recorder->close();
+            std::cout << "[Main] Recorded " << recorder->records() << " register blocks" << std::endl;
+        }
 
         std::cout << "\n[Main] Clean exit completed." << std::endl;
         return 0;
@@ -277,6 +475,8 @@ int main()
         std::cerr << "\n[Main] FATAL ERROR: " << e.what() << std::endl;
         db_voltage_queue.close();
         db_temperature_queue.close();
+        voltage_alarm_queue.close();
+        temperature_alarm_queue.close();
         soc_voltage_queue.close();
         soc_temperature_queue.close();
         soh_voltage_queue.close();
@@ -7,12 +7,21 @@
  */
 
 #include "modbus_reader.hpp"
+#include "modbus_frame.hpp"
 
 #include <modbus/modbus.h>
 
+#include <poll.h>
+#include <sys/socket.h>
+
+#include <algorithm>
 #include <cerrno>
+#include <cmath>
 #include <cstring>
+#include <ctime>
 #include <iostream>
+#include <map>
+#include <utility>
 
 namespace bms
 {
@@ -26,86 +35,383 @@ static modbus_t *as_modbus(void *p) noexcept
         return reinterpret_cast<modbus_t *>(p);
     }
 
+    /** @brief Asks the kernel to timestamp every received segment of a socket.
+ * @param[in] fd Connected socket.
+ * @return False when the platform or socket does not support SO_TIMESTAMPNS.
+ */
+static bool enable_rx_timestamps(int fd) noexcept
+    {
+#ifdef SO_TIMESTAMPNS
+        const int on = 1;
+        return ::setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) == 0;
+#else
+        (void)fd;
+        return false;
+#endif
+    }
+
+    /** @brief recv() that also returns the arrival time of the received data.
+ * @param[out] rx_time Kernel receive timestamp, or the current time when none was attached.
+ * @param[out] kernel True when @p rx_time came from the kernel.
+ * @return Same as recv().
+ */
+static ssize_t recv_timestamped(int fd,
+                                    std::uint8_t *buf,
+                                    std::size_t len,
+                                    std::chrono::system_clock::time_point &rx_time,
+                                    bool &kernel) noexcept
+    {
+        iovec iov{buf, len};
+        alignas(cmsghdr) std::uint8_t control[CMSG_SPACE(3 * sizeof(timespec))];
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        const ssize_t n = ::recvmsg(fd, &msg, 0);
+        if (n <= 0)
+        {
+            return n;
+        }
+
+        rx_time = std::chrono::system_clock::now();
+        kernel = false;
+#ifdef SO_TIMESTAMPNS
+        for (cmsghdr *c = CMSG_FIRSTHDR(&msg); c != nullptr; c = CMSG_NXTHDR(&msg, c))
+        {
+            if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPNS)
+            {
+                timespec ts{};
+                std::memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+                rx_time = std::chrono::system_clock::time_point(
+                    std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                        std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec)));
+                kernel = true;
+            }
+        }
+#endif
+        return n;
+    }
+
+    /** @brief Creates an unconnected gateway for one endpoint.
+ * @param[in] host Gateway address.
+ * @param[in] port Gateway TCP port.
+ */
+ModbusGateway::ModbusGateway(std::string host, int port)
+        : host_(std::move(host)), port_(port)
+    {
+    }
+
+    /** @brief Closes and frees the shared link; every client has released it by now. */
+ModbusGateway::~ModbusGateway()
+    {
+        if (ctx_)
+        {
+            modbus_close(as_modbus(ctx_));
+            modbus_free(as_modbus(ctx_));
+        }
+    }
+
+    /** @brief Looks up or creates the shared gateway of an endpoint.
+ * @param[in] host Gateway address.
+ * @param[in] port Gateway TCP port.
+ * @return Gateway shared by every client of @p host:@p port.
+ */
+std::shared_ptr<ModbusGateway> ModbusGateway::acquire(const std::string &host, int port)
+    {
+        static std::mutex registry_mutex;
+        static std::map<std::pair<std::string, int>, std::weak_ptr<ModbusGateway>> registry;
+
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        auto &slot = registry[{host, port}];
+        std::shared_ptr<ModbusGateway> gateway = slot.lock();
+        if (!gateway)
+        {
+            gateway = std::make_shared<ModbusGateway>(host, port);
+            slot = gateway;
+        }
+        return gateway;
+    }
+
+    /** @brief Takes the gateway lock and attaches the shared link (outermost lease only).
+ * @param[in] client Client about to use its connection.
+ */
+ModbusTcpClient::LinkLease::LinkLease(ModbusTcpClient &client)
+        : client_(client)
+    {
+        if (client_.gateway_ && client_.lease_depth_++ == 0)
+        {
+            lock_ = std::unique_lock<std::mutex>(client_.gateway_->mutex_);
+            outer_ = true;
+            client_.attach_link_();
+        }
+    }
+
+    /** @brief Publishes the link state back to the gateway and releases the lock. */
+ModbusTcpClient::LinkLease::~LinkLease()
+    {
+        if (client_.gateway_)
+        {
+            if (outer_)
+            {
+                client_.detach_link_();
+            }
+            --client_.lease_depth_;
+        }
+    }
+
+    /** @brief Mirrors the gateway link into this client and addresses this client's unit.
+ * @note Called with the gateway lock held.
+ */
+void ModbusTcpClient::attach_link_()
+    {
+        ctx_ = gateway_->ctx_;
+        connected_ = ctx_ != nullptr && gateway_->connected_.load();
+        next_transaction_id_ = gateway_->next_transaction_id_;
+        if (ctx_)
+        {
+            modbus_set_slave(as_modbus(ctx_), cfg_.unit_id);
+            apply_timeouts_();
+        }
+    }
+
+    /** @brief Hands the (possibly reconnected or failed) link back to the gateway.
+ * @note Called with the gateway lock held.
+ */
+void ModbusTcpClient::detach_link_()
+    {
+        gateway_->ctx_ = ctx_;
+        gateway_->connected_.store(connected_);
+        gateway_->next_transaction_id_ = next_transaction_id_;
+    }
+
+    /** @brief Applies this client's response and byte timeouts to the active context. */
+void ModbusTcpClient::apply_timeouts_()
+    {
+        apply_response_timeout_();
+        if (ctx_)
+        {
+            modbus_set_byte_timeout(as_modbus(ctx_),
+                                    static_cast<std::uint32_t>(cfg_.byte_timeout_sec),
+                                    static_cast<std::uint32_t>(cfg_.byte_timeout_usec));
+        }
+    }
+
     /** @brief Creates a MODBUS/TCP client with a copied configuration.
  * @param[in] cfg Host, unit ID, timeout and retry parameters.
  */
 ModbusTcpClient::ModbusTcpClient(ModbusTcpConfig cfg)
-        : cfg_(std::move(cfg))
+        : cfg_(std::move(cfg)),
+          bg_rng_(std::random_device{}())
     {
+        if (cfg_.share_connection)
+        {
+            gateway_ = ModbusGateway::acquire(cfg_.host, cfg_.port);
+        }
+        status_.effective_pipeline_window = std::max(1, cfg_.pipeline_window);
+        status_.response_timeout_ms = cfg_.response_timeout_sec * 1000 + cfg_.response_timeout_usec / 1000;
+        bg_backoff_ = std::chrono::milliseconds(cfg_.reconnect_backoff_initial_ms);
+
+        if (cfg_.background_reconnect)
+        {
+            reconnect_thread_ = boost::thread(&ModbusTcpClient::reconnect_loop_, this);
+        }
     }
 
-    /** @brief Closes and frees any active MODBUS context. */
+    /** @brief Stops background reconnects, then closes and frees any active MODBUS context. */
 ModbusTcpClient::~ModbusTcpClient()
     {
+        {
+            std::lock_guard<std::mutex> lock(bg_mutex_);
+            bg_stop_ = true;
+        }
+        bg_cv_.notify_all();
+        if (reconnect_thread_.joinable())
+        {
+            reconnect_thread_.join();
+        }
         disconnect();
     }
 
-    /** @brief Establishes a new TCP session to the configured MODBUS device.
- * @return True when the connection is established, otherwise false.
+    /** @brief Builds a libmodbus context and connects it.
+ * @param[in] attempts Number of modbus_connect attempts.
+ * @param[out] error_out errno of the last failure.
+ * @return Connected opaque context, or nullptr on failure.
+ * @note Only reads immutable endpoint fields so it may run on the reconnect thread.
  */
-bool ModbusTcpClient::connect()
+void *ModbusTcpClient::open_context_(int attempts, int &error_out) const
     {
-        disconnect();
-
         // Build and configure a fresh libmodbus context for this endpoint.
         modbus_t *ctx = modbus_new_tcp(cfg_.host.c_str(), cfg_.port);
         if (!ctx)
         {
-            update_error_("modbus_new_tcp");
-            status_.connect_failures++;
-            return false;
+            error_out = errno;
+            return nullptr;
         }
 
-        if (modbus_set_slave(ctx, cfg_.unit_id) == -1)
+        // Timeouts are re-applied by the owner on adoption; connect with the ceiling.
+        const int timeout_ms = std::max(cfg_.adaptive_timeout_ceiling_ms, 1);
+        if (modbus_set_slave(ctx, cfg_.unit_id) == -1 ||
+            modbus_set_response_timeout(ctx,
+                                        static_cast<std::uint32_t>(timeout_ms / 1000),
+                                        static_cast<std::uint32_t>((timeout_ms % 1000) * 1000)) == -1)
         {
-            update_error_("modbus_set_slave");
+            error_out = errno;
             modbus_free(ctx);
-            status_.connect_failures++;
-            return false;
+            return nullptr;
         }
 
-        // Configure timeouts (cast to uint32_t for libmodbus API)
-        if (modbus_set_response_timeout(ctx,
-                                        static_cast<std::uint32_t>(cfg_.response_timeout_sec),
-                                        static_cast<std::uint32_t>(cfg_.response_timeout_usec)) == -1)
+        // Retry transient connect failures using the given attempt budget.
+        for (int attempt = 0; attempt < attempts; ++attempt)
         {
-            update_error_("modbus_set_response_timeout");
-            modbus_free(ctx);
-            status_.connect_failures++;
-            return false;
+            if (modbus_connect(ctx) == 0)
+            {
+                if (cfg_.kernel_timestamps)
+                {
+                    // Best effort: without it, arrival falls back to user-space time.
+                    enable_rx_timestamps(modbus_get_socket(ctx));
+                }
+                return ctx;
+            }
+            error_out = errno;
         }
 
-        if (modbus_set_byte_timeout(ctx,
-                                    static_cast<std::uint32_t>(cfg_.byte_timeout_sec),
-                                    static_cast<std::uint32_t>(cfg_.byte_timeout_usec)) == -1)
+        modbus_free(ctx);
+        return nullptr;
+    }
+
+    /** @brief Establishes a new TCP session to the configured MODBUS device.
+ * @return True when the connection is established, otherwise false.
+ */
+bool ModbusTcpClient::connect()
+    {
+        if (gateway_)
         {
-            update_error_("modbus_set_byte_timeout");
-            modbus_free(ctx);
+            return connect_shared_();
+        }
+
+        disconnect();
+
+        int error = 0;
+        void *ctx = open_context_(std::max(1, cfg_.connect_retries), error);
+        if (!ctx)
+        {
+            errno = error;
+            update_error_("modbus_connect");
             status_.connect_failures++;
+            if (cfg_.background_reconnect)
+            {
+                open_circuit_();
+            }
             return false;
         }
 
-        // Retry transient connect failures using configured attempt budget.
-        for (int attempt = 0; attempt < cfg_.connect_retries; ++attempt)
+        ctx_ = ctx;
+        connected_ = true;
+        consecutive_failures_ = 0;
+        status_.circuit_state = CircuitState::Closed;
+
+        // Configure timeouts (cast to uint32_t for libmodbus API); the response timeout
+        // is the effective one, which may already have been adapted to measured RTT.
+        apply_timeouts_();
+        return true;
+    }
+
+    /** @brief Attaches to the gateway link, opening it if no other unit has.
+ * @return True when the shared link is up.
+ */
+bool ModbusTcpClient::connect_shared_()
+    {
+        LinkLease lease(*this);
         {
-            if (modbus_connect(ctx) == 0)
+            std::lock_guard<std::mutex> lock(bg_mutex_);
+            bg_wanted_ = false;
+        }
+        link_ready_.store(false);
+
+        if (!is_connected())
+        {
+            // Dead or never-opened link: replace it for every unit behind the gateway.
+            if (ctx_)
             {
-                ctx_ = ctx;
-                connected_ = true;
-                return true;
+                modbus_close(as_modbus(ctx_));
+                modbus_free(as_modbus(ctx_));
+                ctx_ = nullptr;
             }
-            update_error_("modbus_connect");
+
+            int error = 0;
+            void *ctx = open_context_(std::max(1, cfg_.connect_retries), error);
+            if (!ctx)
+            {
+                errno = error;
+                update_error_("modbus_connect");
+                status_.connect_failures++;
+                if (cfg_.background_reconnect)
+                {
+                    open_circuit_();
+                }
+                return false;
+            }
+            ctx_ = ctx;
+            connected_ = true;
+            gateway_->connects_.fetch_add(1);
         }
 
-        modbus_free(ctx);
-        status_.connect_failures++;
-        return false;
+        consecutive_failures_ = 0;
+        status_.circuit_state = CircuitState::Closed;
+        apply_timeouts_();
+        return true;
     }
 
-    /** @brief Closes the current TCP session if one is active. */
+    /** @brief Reopens the gateway link from the reconnect thread unless another unit already has.
+ * @param[out] error_out errno of a failed attempt.
+ * @return True when the shared link is up.
+ */
+bool ModbusTcpClient::relink_gateway_(int &error_out)
+    {
+        std::lock_guard<std::mutex> lock(gateway_->mutex_);
+        if (gateway_->ctx_ && gateway_->connected_.load())
+        {
+            return true;
+        }
+
+        void *ctx = open_context_(1, error_out);
+        if (!ctx)
+        {
+            return false;
+        }
+        if (gateway_->ctx_)
+        {
+            modbus_close(as_modbus(gateway_->ctx_));
+            modbus_free(as_modbus(gateway_->ctx_));
+        }
+        gateway_->ctx_ = ctx;
+        gateway_->connected_.store(true);
+        gateway_->connects_.fetch_add(1);
+        return true;
+    }
+
+    /** @brief Closes the current TCP session and cancels pending background reconnects. */
 void ModbusTcpClient::disconnect()
     {
-        if (ctx_)
+        {
+            std::lock_guard<std::mutex> lock(bg_mutex_);
+            bg_wanted_ = false;
+        }
+        if (void *ready = ready_ctx_.exchange(nullptr, boost::memory_order_acq_rel))
+        {
+            modbus_close(as_modbus(ready));
+            modbus_free(as_modbus(ready));
+        }
+        link_ready_.store(false);
+
+        if (gateway_)
+        {
+            // The link stays up for the other units; the gateway closes it when released.
+            ctx_ = nullptr;
+        }
+        else if (ctx_)
         {
             modbus_t *ctx = as_modbus(ctx_);
             if (connected_)
@@ -116,6 +422,7 @@ void ModbusTcpClient::disconnect()
             ctx_ = nullptr;
         }
         connected_ = false;
+        status_.circuit_state = CircuitState::Closed;
     }
 
     /** @brief Reports whether a valid MODBUS session is currently open.
@@ -128,6 +435,7 @@ bool ModbusTcpClient::is_connected() const noexcept
 
     /** @brief Reconnects on-demand when a read is attempted while disconnected.
  * @return True if connected after the check, otherwise false.
+ * @note With background reconnect the breaker owns reconnection; this never blocks.
  */
 bool ModbusTcpClient::ensure_connected_()
     {
@@ -135,10 +443,213 @@ bool ModbusTcpClient::ensure_connected_()
         {
             return true;
         }
+        if (cfg_.background_reconnect)
+        {
+            return false;
+        }
         status_.reconnects++;
         return connect();
     }
 
+    /** @brief Swaps in a context connected by the reconnect thread, if one is ready. */
+void ModbusTcpClient::adopt_background_context_()
+    {
+        status_.background_connect_attempts = bg_attempts_.load(boost::memory_order_relaxed);
+
+        if (gateway_)
+        {
+            // The link belongs to the gateway and is already attached by the lease.
+            if (link_ready_.exchange(false))
+            {
+                status_.reconnects++;
+                status_.circuit_state = CircuitState::HalfOpen;
+            }
+            return;
+        }
+
+        void *ready = ready_ctx_.exchange(nullptr, boost::memory_order_acq_rel);
+        if (!ready)
+        {
+            return;
+        }
+
+        if (ctx_)
+        {
+            modbus_free(as_modbus(ctx_));
+        }
+        ctx_ = ready;
+        connected_ = true;
+        status_.reconnects++;
+        status_.circuit_state = CircuitState::HalfOpen;
+
+        apply_timeouts_();
+    }
+
+    /** @brief Decides whether a read may touch the network.
+ * @return False when the circuit is open and the read must fail fast.
+ */
+bool ModbusTcpClient::admit_request_()
+    {
+        if (!cfg_.background_reconnect)
+        {
+            return true;
+        }
+
+        adopt_background_context_();
+        if (status_.circuit_state == CircuitState::Open)
+        {
+            const int err = bg_last_errno_.load(boost::memory_order_relaxed);
+            errno = err != 0 ? err : ENOTCONN;
+            update_error_("circuit open");
+            return false;
+        }
+        if (!is_connected())
+        {
+            // Lost or never-established link: hand it to the reconnect thread.
+            open_circuit_();
+            errno = ENOTCONN;
+            update_error_("circuit open");
+            return false;
+        }
+        return true;
+    }
+
+    /** @brief Updates breaker state after a read completes.
+ * @param[in] ok Whether the read succeeded.
+ */
+void ModbusTcpClient::on_read_outcome_(bool ok)
+    {
+        if (ok)
+        {
+            consecutive_failures_ = 0;
+            if (status_.circuit_state == CircuitState::HalfOpen)
+            {
+                status_.circuit_state = CircuitState::Closed;
+                std::lock_guard<std::mutex> lock(bg_mutex_);
+                bg_backoff_ = std::chrono::milliseconds(cfg_.reconnect_backoff_initial_ms);
+            }
+            return;
+        }
+
+        ++consecutive_failures_;
+        if (!cfg_.background_reconnect)
+        {
+            return;
+        }
+
+        // A failed probe, a dead link, or too many failures in a row opens the circuit.
+        if (status_.circuit_state == CircuitState::HalfOpen ||
+            !is_connected() ||
+            consecutive_failures_ >= std::max(1, cfg_.breaker_failure_threshold))
+        {
+            open_circuit_();
+        }
+    }
+
+    /** @brief Drops the current session and schedules background reconnection. */
+void ModbusTcpClient::open_circuit_()
+    {
+        // A shared link is left to the other units; if it is dead, the reconnect thread
+        // replaces it through the gateway.
+        if (!gateway_)
+        {
+            if (ctx_)
+            {
+                modbus_t *ctx = as_modbus(ctx_);
+                if (connected_)
+                {
+                    modbus_close(ctx);
+                }
+                modbus_free(ctx);
+                ctx_ = nullptr;
+            }
+            connected_ = false;
+        }
+        consecutive_failures_ = 0;
+
+        if (status_.circuit_state != CircuitState::Open)
+        {
+            status_.circuit_state = CircuitState::Open;
+            status_.circuit_opens++;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(bg_mutex_);
+            bg_wanted_ = true;
+        }
+        bg_cv_.notify_all();
+    }
+
+    /** @brief Returns the next reconnect delay with jitter and doubles the base backoff.
+ * @note Called with bg_mutex_ held.
+ */
+std::chrono::milliseconds ModbusTcpClient::next_backoff_()
+    {
+        const double jitter = std::clamp(cfg_.reconnect_backoff_jitter, 0.0, 1.0);
+        std::uniform_real_distribution<double> dist(1.0 - jitter, 1.0 + jitter);
+        const auto delay = std::chrono::milliseconds(
+            static_cast<std::int64_t>(static_cast<double>(bg_backoff_.count()) * dist(bg_rng_)));
+
+        bg_backoff_ = std::min(bg_backoff_ * 2, std::chrono::milliseconds(cfg_.reconnect_backoff_max_ms));
+        return delay;
+    }
+
+    /** @brief Reconnect thread: connects off the read path whenever the circuit is open. */
+void ModbusTcpClient::reconnect_loop_()
+    {
+        std::unique_lock<std::mutex> lock(bg_mutex_);
+        while (true)
+        {
+            bg_cv_.wait(lock, [this] { return bg_stop_ || bg_wanted_; });
+            if (bg_stop_)
+            {
+                return;
+            }
+
+            // Sleep out the backoff; wake early on shutdown or cancellation.
+            const auto delay = next_backoff_();
+            if (bg_cv_.wait_for(lock, delay, [this] { return bg_stop_ || !bg_wanted_; }))
+            {
+                continue;
+            }
+
+            lock.unlock();
+            int error = 0;
+            void *ctx = nullptr;
+            const bool linked = gateway_ ? relink_gateway_(error) : false;
+            if (!gateway_)
+            {
+                ctx = open_context_(1, error);
+            }
+            bg_attempts_.fetch_add(1, boost::memory_order_relaxed);
+            lock.lock();
+
+            if (!ctx && !linked)
+            {
+                bg_last_errno_.store(error, boost::memory_order_relaxed);
+                continue;
+            }
+
+            if (bg_wanted_ && !bg_stop_)
+            {
+                bg_wanted_ = false;
+                if (linked)
+                {
+                    link_ready_.store(true);
+                }
+                else
+                {
+                    ready_ctx_.store(ctx, boost::memory_order_release);
+                }
+            }
+            else if (ctx)
+            {
+                modbus_close(as_modbus(ctx));
+                modbus_free(as_modbus(ctx));
+            }
+        }
+    }
+
     /**
  * @brief Reads a contiguous block of MODBUS input registers.
  * @param[in] addr First register address.
@@ -150,45 +661,735 @@ bool ModbusTcpClient::read_input_registers(
         int addr,
         int count,
         std::uint16_t *dest)
+    {
+        return read_registers_(kFcReadInputRegisters, addr, count, dest);
+    }
+
+    /**
+ * @brief Reads a contiguous block of MODBUS holding registers.
+ * @param[in] addr First register address.
+ * @param[in] count Number of 16-bit registers to read.
+ * @param[out] dest Output buffer receiving register words.
+ * @return True when all requested registers are read, otherwise false.
+ */
+bool ModbusTcpClient::read_holding_registers(
+        int addr,
+        int count,
+        std::uint16_t *dest)
+    {
+        return read_registers_(kFcReadHoldingRegisters, addr, count, dest);
+    }
+
+    /**
+ * @brief Shared retry/breaker path for register reads.
+ * @param[in] function MODBUS read function code (0x03 or 0x04).
+ */
+bool ModbusTcpClient::read_registers_(
+        std::uint8_t function,
+        int addr,
+        int count,
+        std::uint16_t *dest)
     {
         if (!dest || count <= 0)
         {
             errno = EINVAL;
-            update_error_("read_input_registers invalid args");
+            update_error_("read_registers invalid args");
             status_.read_failures++;
             return false;
         }
 
-        // Retry read failures and force reconnect between attempts.
-        for (int attempt = 0; attempt <= cfg_.read_retries; ++attempt)
+        LinkLease lease(*this);
+
+        last_read_skipped_ = false;
+        if (!admit_request_())
+        {
+            last_read_skipped_ = true;
+            status_.fast_failures++;
+            status_.read_failures++;
+            return false;
+        }
+
+        // A half-open circuit gets exactly one probe attempt.
+        const int retries = status_.circuit_state == CircuitState::HalfOpen ? 0 : cfg_.read_retries;
+
+        // Retry read failures; only transport errors force a reconnect between attempts.
+        for (int attempt = 0; attempt <= retries; ++attempt)
         {
             if (!ensure_connected_())
             {
-                status_.read_failures++;
+                // After a transport failure the previous attempt was already counted.
+                if (attempt == 0)
+                {
+                    status_.read_failures++;
+                }
+                on_read_outcome_(false);
                 return false;
             }
 
             modbus_t *ctx = as_modbus(ctx_);
-            // const int rc = modbus_read_registers(ctx, addr, count, dest);
-            const int rc = modbus_read_input_registers(ctx, addr, count, dest);
+            const auto started = std::chrono::steady_clock::now();
+            int rc = 0;
+            if (cfg_.kernel_timestamps)
+            {
+                rc = read_framed_(function, addr, count, dest);
+            }
+            else
+            {
+                last_exchange_.sent = std::chrono::system_clock::now();
+                rc = function == kFcReadHoldingRegisters
+                         ? modbus_read_registers(ctx, addr, count, dest)
+                         : modbus_read_input_registers(ctx, addr, count, dest);
+                last_exchange_.received = std::chrono::system_clock::now();
+                last_exchange_.kernel_rx = false;
+            }
 
             if (rc == count)
             {
+                record_rtt_(std::chrono::steady_clock::now() - started);
                 status_.successful_reads++;
+                on_read_outcome_(true);
                 return true;
             }
 
-            // Read failed - flush and force reconnect
             update_error_("modbus_read_registers");
             status_.read_failures++;
+            const int err = errno;
             modbus_flush(ctx);
+
+            // A lost frame or protocol-level error leaves the session usable, so retry on
+            // the same connection. The framed path skips a late reply to a timed-out
+            // request by transaction ID; libmodbus instead fails the next read with
+            // EMBBADDATA when the late reply arrives first, which costs one retry.
+            if (err == ETIMEDOUT)
+            {
+                status_.timeouts++;
+                continue;
+            }
+            if (err >= MODBUS_ENOBASE)
+            {
+                continue;
+            }
+
+            // Transport failure - force reconnect
             modbus_close(ctx);
             connected_ = false;
         }
 
+        on_read_outcome_(false);
         return false;
     }
 
+    /**
+ * @brief One read transaction framed and received here instead of by libmodbus.
+ * @details Owning the receive call is what gives access to the SO_TIMESTAMPNS control
+ * message. Late answers to earlier, timed-out requests are skipped by transaction ID;
+ * bytes trailing the answer cannot belong to any request, so the link is replaced.
+ * @return @p count on success, otherwise -1 with errno set the way libmodbus sets it.
+ */
+int ModbusTcpClient::read_framed_(
+        std::uint8_t function,
+        int addr,
+        int count,
+        std::uint16_t *dest)
+    {
+        const int fd = modbus_get_socket(as_modbus(ctx_));
+        const std::uint16_t tid = next_transaction_id_++;
+
+        std::uint8_t adu[kReadRequestAduSize];
+        build_read_request(adu,
+                           tid,
+                           static_cast<std::uint8_t>(cfg_.unit_id),
+                           function,
+                           static_cast<std::uint16_t>(addr),
+                           static_cast<std::uint16_t>(count));
+
+        last_exchange_.sent = std::chrono::system_clock::now();
+        const ssize_t sent = ::send(fd, adu, sizeof(adu), MSG_NOSIGNAL);
+        if (sent != static_cast<ssize_t>(sizeof(adu)))
+        {
+            if (sent >= 0)
+            {
+                errno = EIO;
+            }
+            return -1;
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(status_.response_timeout_ms);
+        std::array<std::uint8_t, kMaxAduSize * 2> rx{};
+        std::size_t rx_size = 0;
+        while (true)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            const int wait_ms = now >= deadline
+                                    ? 0
+                                    : static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count());
+            pollfd pfd{fd, POLLIN, 0};
+            const int prc = ::poll(&pfd, 1, wait_ms);
+            if (prc == 0)
+            {
+                errno = ETIMEDOUT;
+                return -1;
+            }
+            if (prc < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return -1;
+            }
+
+            std::chrono::system_clock::time_point rx_time{};
+            bool kernel_rx = false;
+            const ssize_t n = recv_timestamped(fd, rx.data() + rx_size, rx.size() - rx_size, rx_time, kernel_rx);
+            if (n <= 0)
+            {
+                if (n < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (n == 0)
+                {
+                    errno = ECONNRESET;
+                }
+                return -1;
+            }
+            rx_size += static_cast<std::size_t>(n);
+
+            while (rx_size >= kMbapHeaderSize)
+            {
+                MbapHeader header;
+                if (!parse_mbap_header(rx.data(), header))
+                {
+                    errno = EMBBADDATA;
+                    return -1;
+                }
+                const std::size_t size = adu_size(header);
+                if (rx_size < size)
+                {
+                    break;
+                }
+
+                if (header.transaction_id != tid)
+                {
+                    // Late answer to an earlier request that already timed out.
+                    std::memmove(rx.data(), rx.data() + size, rx_size - size);
+                    rx_size -= size;
+                    continue;
+                }
+                if (header.unit_id != static_cast<std::uint8_t>(cfg_.unit_id))
+                {
+                    errno = EMBBADSLAVE;
+                    return -1;
+                }
+
+                std::uint8_t exception_code = 0;
+                const FrameStatus st = parse_read_response(rx.data(),
+                                                           size,
+                                                           function,
+                                                           static_cast<std::uint16_t>(count),
+                                                           dest,
+                                                           exception_code);
+                if (st == FrameStatus::Malformed)
+                {
+                    errno = EMBBADDATA;
+                    return -1;
+                }
+                if (st == FrameStatus::Exception)
+                {
+                    errno = MODBUS_ENOBASE + exception_code;
+                    return -1;
+                }
+
+                last_exchange_.received = rx_time;
+                last_exchange_.kernel_rx = kernel_rx;
+                if (kernel_rx)
+                {
+                    status_.kernel_rx_timestamps++;
+                }
+                if (rx_size > size)
+                {
+                    // Nothing else is in flight, so trailing bytes would misalign the
+                    // next exchange; keep this answer and read the next one on a fresh link.
+                    errno = EPROTO;
+                    update_error_("trailing response data");
+                    status_.stream_resyncs++;
+                    resync_link_();
+                }
+                return count;
+            }
+        }
+    }
+
+    /**
+ * @brief Writes a contiguous block of MODBUS holding registers.
+ * @param[in] addr First register address.
+ * @param[in] count Number of 16-bit registers to write.
+ * @param[in] src Register words to write.
+ * @return True when the device acknowledged the full write, otherwise false.
+ */
+bool ModbusTcpClient::write_registers(
+        int addr,
+        int count,
+        const std::uint16_t *src)
+    {
+        if (!src || count <= 0 || count > static_cast<int>(kMaxWriteRegisters))
+        {
+            errno = EINVAL;
+            update_error_("write_registers invalid args");
+            status_.write_failures++;
+            return false;
+        }
+
+        LinkLease lease(*this);
+        last_read_skipped_ = false;
+        if (!admit_request_())
+        {
+            last_read_skipped_ = true;
+            status_.fast_failures++;
+            status_.write_failures++;
+            return false;
+        }
+
+        if (!ensure_connected_())
+        {
+            status_.write_failures++;
+            on_read_outcome_(false);
+            return false;
+        }
+
+        // Single attempt: see the header for why writes are never retried here.
+        modbus_t *ctx = as_modbus(ctx_);
+        const auto started = std::chrono::steady_clock::now();
+        last_exchange_.sent = std::chrono::system_clock::now();
+        const int rc = modbus_write_registers(ctx, addr, count, src);
+        if (rc == count)
+        {
+            last_exchange_.received = std::chrono::system_clock::now();
+            last_exchange_.kernel_rx = false;
+            record_rtt_(std::chrono::steady_clock::now() - started);
+            status_.successful_writes++;
+            on_read_outcome_(true);
+            return true;
+        }
+
+        update_error_("modbus_write_registers");
+        status_.write_failures++;
+        const int err = errno;
+        modbus_flush(ctx);
+        if (err == ETIMEDOUT)
+        {
+            status_.timeouts++;
+        }
+        else if (err < MODBUS_ENOBASE)
+        {
+            // Transport failure - force reconnect
+            modbus_close(ctx);
+            connected_ = false;
+        }
+
+        on_read_outcome_(false);
+        return false;
+    }
+
+    /**
+ * @brief Feeds one successful round-trip into the RTT histogram.
+ * @param[in] rtt Request-to-response latency.
+ */
+void ModbusTcpClient::record_rtt_(std::chrono::steady_clock::duration rtt)
+    {
+        const auto us = std::chrono::duration_cast<std::chrono::microseconds>(rtt).count();
+        rtt_histogram_.record(us > 0 ? static_cast<std::uint64_t>(us) : 0u);
+
+        // Periodically age the histogram so the estimate follows network changes.
+        if (cfg_.rtt_decay_every > 0 && ++rtt_samples_since_decay_ >= cfg_.rtt_decay_every)
+        {
+            rtt_histogram_.decay();
+            rtt_samples_since_decay_ = 0;
+        }
+
+        if (++rtt_samples_since_retune_ >= std::max<std::uint32_t>(1, cfg_.adaptive_retune_every))
+        {
+            retune_timeout_();
+            rtt_samples_since_retune_ = 0;
+        }
+    }
+
+    /**
+ * @brief Refreshes RTT percentiles and derives the response timeout from p99.
+ */
+void ModbusTcpClient::retune_timeout_()
+    {
+        status_.rtt = rtt_histogram_.snapshot();
+        if (!cfg_.adaptive_timeout || status_.rtt.count < cfg_.adaptive_min_samples)
+        {
+            return;
+        }
+
+        const double scaled_ms = static_cast<double>(status_.rtt.p99_us) * cfg_.adaptive_timeout_multiplier / 1000.0;
+        const auto target_ms = std::clamp<std::int64_t>(
+            static_cast<std::int64_t>(std::ceil(scaled_ms)),
+            cfg_.adaptive_timeout_floor_ms,
+            cfg_.adaptive_timeout_ceiling_ms);
+
+        if (target_ms != status_.response_timeout_ms)
+        {
+            status_.response_timeout_ms = target_ms;
+            apply_response_timeout_();
+        }
+    }
+
+    /**
+ * @brief Pushes the effective response timeout into the active libmodbus context.
+ */
+void ModbusTcpClient::apply_response_timeout_()
+    {
+        if (ctx_)
+        {
+            modbus_set_response_timeout(as_modbus(ctx_),
+                                        static_cast<std::uint32_t>(status_.response_timeout_ms / 1000),
+                                        static_cast<std::uint32_t>((status_.response_timeout_ms % 1000) * 1000));
+        }
+    }
+
+    /**
+ * @brief Reads a batch of register ranges one transaction at a time.
+ * @param[in,out] requests Batch entries; each @c ok flag is updated.
+ * @return True when every request succeeded.
+ */
+bool ModbusTcpClient::read_sequential_(std::span<ModbusReadRequest> requests)
+    {
+        bool all_ok = true;
+        for (auto &req : requests)
+        {
+            if (!req.ok)
+            {
+                req.ok = read_registers_(req.function, req.addr, req.count, req.dest);
+                all_ok = all_ok && req.ok;
+            }
+        }
+        return all_ok;
+    }
+
+    /**
+ * @brief Records a pipelined batch that broke the protocol and resynchronizes the stream.
+ * @details After @c pipeline_violation_threshold such batches in a row the client drops
+ * to one transaction in flight until @ref reprobe_pipeline_window_ restores the window.
+ * @param[in] reason Error prefix recorded in the status.
+ */
+void ModbusTcpClient::on_pipeline_violation_(const char *reason)
+    {
+        errno = EPROTO;
+        update_error_(reason);
+        status_.pipeline_violations++;
+
+        // Outstanding responses would desynchronize the fallback reads; start from a
+        // clean stream.
+        resync_link_();
+
+        if (++consecutive_pipeline_violations_ < std::max(1, cfg_.pipeline_violation_threshold))
+        {
+            return;
+        }
+
+        consecutive_pipeline_violations_ = 0;
+        status_.pipeline_fallbacks++;
+        status_.effective_pipeline_window = 1;
+        pipeline_reprobe_at_ = std::chrono::steady_clock::now() +
+                               std::chrono::seconds(cfg_.pipeline_reprobe_after_s);
+        // The resync reconnect above does not end the fallback; a later one does.
+        pipeline_fallback_reconnects_ = status_.reconnects;
+    }
+
+    /**
+ * @brief Replaces a link whose byte stream can no longer be trusted, so the next read
+ *        starts on a fresh stream instead of finding the client disconnected.
+ * @details A single connect attempt; when it fails later reads take the usual
+ * disconnected path (the breaker, or an on-demand reconnect without one).
+ * @note Runs under the link lease, so a gateway link is replaced for every unit.
+ */
+void ModbusTcpClient::resync_link_()
+    {
+        if (ctx_)
+        {
+            modbus_close(as_modbus(ctx_));
+            modbus_free(as_modbus(ctx_));
+            ctx_ = nullptr;
+        }
+        connected_ = false;
+
+        int error = 0;
+        void *ctx = open_context_(1, error);
+        if (!ctx)
+        {
+            errno = error;
+            update_error_("modbus_connect");
+            status_.connect_failures++;
+            return;
+        }
+
+        ctx_ = ctx;
+        connected_ = true;
+        status_.reconnects++;
+        if (gateway_)
+        {
+            gateway_->connects_.fetch_add(1);
+        }
+        apply_timeouts_();
+    }
+
+    /** @brief Restores the configured window once the fallback cooldown expired or the
+ *         device reconnected since.
+ */
+void ModbusTcpClient::reprobe_pipeline_window_()
+    {
+        const int configured = std::max(1, cfg_.pipeline_window);
+        if (status_.effective_pipeline_window >= configured)
+        {
+            return;
+        }
+        if (std::chrono::steady_clock::now() < pipeline_reprobe_at_ &&
+            status_.reconnects <= pipeline_fallback_reconnects_)
+        {
+            return;
+        }
+
+        status_.effective_pipeline_window = configured;
+        status_.pipeline_reprobes++;
+    }
+
+    /**
+ * @brief Reads several register ranges with overlapping MODBUS/TCP transactions.
+ * @param[in,out] requests Batch entries; each @c ok flag is updated.
+ * @return True when every request succeeded.
+ */
+bool ModbusTcpClient::read_input_registers_pipelined(std::span<ModbusReadRequest> requests)
+    {
+        for (auto &req : requests)
+        {
+            req.function = kFcReadInputRegisters;
+        }
+        return read_registers_pipelined(requests);
+    }
+
+    /**
+ * @brief Reads several register ranges, each with its own read function, with
+ *        overlapping MODBUS/TCP transactions.
+ * @param[in,out] requests Batch entries; each @c ok flag is updated.
+ * @return True when every request succeeded.
+ */
+bool ModbusTcpClient::read_registers_pipelined(std::span<ModbusReadRequest> requests)
+    {
+        for (auto &req : requests)
+        {
+            req.ok = false;
+            if (!req.dest || req.count <= 0 || req.count > static_cast<int>(kMaxReadRegisters) ||
+                (req.function != kFcReadInputRegisters && req.function != kFcReadHoldingRegisters))
+            {
+                errno = EINVAL;
+                update_error_("read_registers_pipelined invalid args");
+                status_.read_failures++;
+                return false;
+            }
+        }
+
+        LinkLease lease(*this);
+        reprobe_pipeline_window_();
+        const std::size_t window = static_cast<std::size_t>(status_.effective_pipeline_window);
+        if (requests.size() <= 1 || window <= 1)
+        {
+            return read_sequential_(requests);
+        }
+
+        // Breaker decisions (fast-fail, half-open probe) live on the sequential path.
+        if (cfg_.background_reconnect)
+        {
+            adopt_background_context_();
+        }
+        if (status_.circuit_state != CircuitState::Closed || !is_connected())
+        {
+            return read_sequential_(requests);
+        }
+
+        status_.pipelined_batches++;
+        const int fd = modbus_get_socket(as_modbus(ctx_));
+        const auto timeout = std::chrono::milliseconds(status_.response_timeout_ms);
+
+        // Transaction IDs are assigned in request order, so the ID offset is the index.
+        const std::uint16_t base_tid = next_transaction_id_;
+        next_transaction_id_ = static_cast<std::uint16_t>(next_transaction_id_ + requests.size());
+
+        std::array<std::uint8_t, kMaxAduSize * 2> rx{};
+        std::size_t rx_size = 0;
+        std::size_t next_to_send = 0;
+        std::size_t outstanding = 0;
+        std::size_t completed = 0;
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        pipeline_sent_at_.resize(requests.size());
+
+        while (completed < requests.size())
+        {
+            // Top up the in-flight window.
+            while (outstanding < window && next_to_send < requests.size())
+            {
+                const auto &req = requests[next_to_send];
+                std::uint8_t adu[kReadRequestAduSize];
+                build_read_request(adu,
+                                   static_cast<std::uint16_t>(base_tid + next_to_send),
+                                   static_cast<std::uint8_t>(cfg_.unit_id),
+                                   req.function,
+                                   static_cast<std::uint16_t>(req.addr),
+                                   static_cast<std::uint16_t>(req.count));
+                if (::send(fd, adu, sizeof(adu), MSG_NOSIGNAL) != static_cast<ssize_t>(sizeof(adu)))
+                {
+                    update_error_("pipelined send");
+                    status_.read_failures++;
+                    resync_link_();
+                    return read_sequential_(requests);
+                }
+                pipeline_sent_at_[next_to_send] = std::chrono::steady_clock::now();
+                ++next_to_send;
+                ++outstanding;
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            const int wait_ms = now >= deadline
+                                    ? 0
+                                    : static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count());
+            pollfd pfd{fd, POLLIN, 0};
+            const int prc = ::poll(&pfd, 1, wait_ms);
+            if (prc == 0)
+            {
+                // A lost frame says nothing about pipelining support: count it like a
+                // sequential timeout and retry what is missing one at a time. Late
+                // answers carry this batch's transaction IDs and are rejected as stale.
+                errno = ETIMEDOUT;
+                update_error_("pipelined response timeout");
+                status_.timeouts++;
+                status_.read_failures++;
+                modbus_flush(as_modbus(ctx_));
+                return read_sequential_(requests);
+            }
+            if (prc < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                update_error_("pipelined poll");
+                resync_link_();
+                return read_sequential_(requests);
+            }
+
+            std::chrono::system_clock::time_point rx_time{};
+            bool kernel_rx = false;
+            const ssize_t n = recv_timestamped(fd, rx.data() + rx_size, rx.size() - rx_size, rx_time, kernel_rx);
+            if (n <= 0)
+            {
+                if (n < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                update_error_("pipelined recv");
+                resync_link_();
+                return read_sequential_(requests);
+            }
+            rx_size += static_cast<std::size_t>(n);
+
+            // Decode every complete ADU in the buffer; responses may be out of order.
+            std::size_t offset = 0;
+            while (rx_size - offset >= kMbapHeaderSize)
+            {
+                MbapHeader header;
+                if (!parse_mbap_header(rx.data() + offset, header))
+                {
+                    on_pipeline_violation_("pipelined mbap header");
+                    return read_sequential_(requests);
+                }
+                const std::size_t size = adu_size(header);
+                if (rx_size - offset < size)
+                {
+                    break;
+                }
+
+                const std::size_t idx = static_cast<std::uint16_t>(header.transaction_id - base_tid);
+                if (idx >= next_to_send ||
+                    requests[idx].ok ||
+                    header.unit_id != static_cast<std::uint8_t>(cfg_.unit_id))
+                {
+                    on_pipeline_violation_("pipelined transaction mismatch");
+                    return read_sequential_(requests);
+                }
+
+                auto &req = requests[idx];
+                std::uint8_t exception_code = 0;
+                const FrameStatus st = parse_read_response(rx.data() + offset,
+                                                           size,
+                                                           req.function,
+                                                           static_cast<std::uint16_t>(req.count),
+                                                           req.dest,
+                                                           exception_code);
+                if (st == FrameStatus::Malformed)
+                {
+                    on_pipeline_violation_("pipelined malformed response");
+                    return read_sequential_(requests);
+                }
+
+                req.ok = (st == FrameStatus::Ok);
+                if (req.ok)
+                {
+                    req.received = rx_time;
+                    record_rtt_(std::chrono::steady_clock::now() - pipeline_sent_at_[idx]);
+                    status_.successful_reads++;
+                    on_read_outcome_(true);
+                    if (kernel_rx)
+                    {
+                        status_.kernel_rx_timestamps++;
+                    }
+                }
+                else
+                {
+                    errno = MODBUS_ENOBASE + exception_code;
+                    update_error_("pipelined exception response");
+                    status_.read_failures++;
+                }
+
+                offset += size;
+                ++completed;
+                --outstanding;
+                deadline = std::chrono::steady_clock::now() + timeout;
+            }
+
+            if (offset > 0)
+            {
+                std::memmove(rx.data(), rx.data() + offset, rx_size - offset);
+                rx_size -= offset;
+            }
+        }
+
+        consecutive_pipeline_violations_ = 0;
+        if (rx_size > 0)
+        {
+            // A partial frame after the last answer would misalign the next exchange.
+            errno = EPROTO;
+            update_error_("trailing response data");
+            status_.stream_resyncs++;
+            resync_link_();
+        }
+
+        // Failures may open the circuit and drop the socket, so report them after the batch.
+        bool all_ok = true;
+        for (const auto &req : requests)
+        {
+            if (!req.ok)
+            {
+                on_read_outcome_(false);
+                all_ok = false;
+            }
+        }
+        return all_ok;
+    }
+
     /**
  * @brief Reads the canonical BMS register block used by acquisition tasks.
  * @param[out] out_regs Fixed-size destination array with 35 register words.
@@ -211,13 +1412,9 @@ void ModbusTcpClient::set_response_timeout(std::chrono::milliseconds timeout)
     {
         cfg_.response_timeout_sec = static_cast<int>(timeout.count() / 1000);
         cfg_.response_timeout_usec = static_cast<int>((timeout.count() % 1000) * 1000);
-
-        if (ctx_)
-        {
-            modbus_set_response_timeout(as_modbus(ctx_),
-                                        static_cast<std::uint32_t>(cfg_.response_timeout_sec),
-                                        static_cast<std::uint32_t>(cfg_.response_timeout_usec));
-        }
+        status_.response_timeout_ms = timeout.count();
+        LinkLease lease(*this);
+        apply_response_timeout_();
     }
 
     /** @brief Updates inter-byte timeout configuration and active context settings.
@@ -228,6 +1425,7 @@ void ModbusTcpClient::set_byte_timeout(std::chrono::milliseconds timeout)
         cfg_.byte_timeout_sec = static_cast<int>(timeout.count() / 1000);
         cfg_.byte_timeout_usec = static_cast<int>((timeout.count() % 1000) * 1000);
 
+        LinkLease lease(*this);
         if (ctx_)
         {
             modbus_set_byte_timeout(as_modbus(ctx_),
@@ -0,0 +1,105 @@
+/**
+ * @file queue_selector.cpp
+ * @brief Doorbell wait loop behind @ref bms::QueueSelector.
+ */
+
+#include "queue_selector.hpp"
+
+namespace bms
+{
+    QueueSelector::~QueueSelector()
+    {
+        for (const Source &source : sources_)
+        {
+            source.detach(source.queue);
+        }
+    }
+
+    std::optional<std::size_t> QueueSelector::poll() noexcept
+    {
+        const std::size_t count = sources_.size();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const std::size_t index = (next_ + i) % count;
+            if (sources_[index].ready(sources_[index].queue))
+            {
+                next_ = index + 1;
+                return index;
+            }
+        }
+        return std::nullopt;
+    }
+
+    bool QueueSelector::all_closed() const noexcept
+    {
+        for (const Source &source : sources_)
+        {
+            // Closed first: a push that lands before close() is then seen as ready.
+            if (!source.closed(source.queue) || source.ready(source.queue))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::optional<std::size_t> QueueSelector::wait() noexcept
+    {
+        for (;;)
+        {
+            if (const auto ready = poll())
+            {
+                return ready;
+            }
+            if (all_closed())
+            {
+                return std::nullopt;
+            }
+
+            const EventCount::key_type key = doorbell_.prepare_wait();
+            if (const auto ready = poll())
+            {
+                doorbell_.cancel_wait();
+                return ready;
+            }
+            if (all_closed())
+            {
+                doorbell_.cancel_wait();
+                return std::nullopt;
+            }
+            doorbell_.wait(key);
+        }
+    }
+
+    std::optional<std::size_t> QueueSelector::wait_until(std::chrono::steady_clock::time_point deadline) noexcept
+    {
+        for (;;)
+        {
+            if (const auto ready = poll())
+            {
+                return ready;
+            }
+            if (all_closed())
+            {
+                return std::nullopt;
+            }
+
+            const EventCount::key_type key = doorbell_.prepare_wait();
+            if (const auto ready = poll())
+            {
+                doorbell_.cancel_wait();
+                return ready;
+            }
+            if (all_closed())
+            {
+                doorbell_.cancel_wait();
+                return std::nullopt;
+            }
+            if (!doorbell_.wait_until(key, deadline))
+            {
+                return poll();
+            }
+        }
+    }
+
+} // namespace bms
@@ -0,0 +1,363 @@
+/**
+ * @file register_decode.cpp
+ * @brief SIMD kernels for big-endian word-pair float decode (AVX2/SSE2/NEON/scalar).
+ */
+
+#include "register_decode.hpp"
+
+#include <bit>
+#include <cassert>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define BMS_DECODE_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define BMS_DECODE_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define BMS_DECODE_NEON 1
+#endif
+
+namespace bms
+{
+    namespace
+    {
+        constexpr std::uint32_t kExponentMask = 0x7F800000u;
+
+        /** @brief Decodes one value for the reference path; flags are set without branches. */
+        inline void decode_one(const std::uint16_t *words,
+                               std::size_t i,
+                               float *out,
+                               const FloatDecodeOptions &opts,
+                               FloatDecodeReport &report) noexcept
+        {
+            const std::uint32_t raw =
+                (static_cast<std::uint32_t>(words[2 * i]) << 16) |
+                static_cast<std::uint32_t>(words[2 * i + 1]);
+
+            float value;
+            std::memcpy(&value, &raw, sizeof(float));
+
+            const bool non_finite = (raw & kExponentMask) == kExponentMask;
+            const bool outside = (value < opts.min) | (value > opts.max);
+            report.non_finite_mask |= static_cast<std::uint32_t>(non_finite) << i;
+            report.out_of_range_mask |= static_cast<std::uint32_t>(outside & !non_finite) << i;
+
+            if (opts.clamp)
+            {
+                // Same operand order as the vector min/max: NaN ends up as min.
+                value = opts.max < value ? opts.max : value;
+                value = value > opts.min ? value : opts.min;
+            }
+            out[i] = value;
+        }
+
+        /** @brief Bit mask selecting the low @p lanes of a movemask result. */
+        inline constexpr std::uint32_t low_lanes(std::size_t lanes) noexcept
+        {
+            return (1u << lanes) - 1u;
+        }
+
+        /**
+         * @brief Word pair @p k of a short tail as one 32-bit lane, 0 past @p rest.
+         * @details Built in registers rather than from a padded copy: a narrow store
+         * followed by a wide load of the same bytes would stall on store forwarding.
+         */
+        inline std::uint32_t tail_pair(const std::uint16_t *words, std::size_t k, std::size_t rest) noexcept
+        {
+            std::uint32_t pair = 0;
+            if (k < rest)
+            {
+                std::memcpy(&pair, words + 2 * k, sizeof(pair));
+            }
+            return pair;
+        }
+
+#if defined(BMS_DECODE_SSE2)
+        /**
+         * @brief Four values: swap the 16-bit halves of each 32-bit lane (high word is
+         * first on the wire), then validate and clamp in registers.
+         */
+        inline __m128 decode4_sse2(__m128i raw,
+                                   const FloatDecodeOptions &opts,
+                                   std::uint32_t &non_finite_bits,
+                                   std::uint32_t &outside_bits) noexcept
+        {
+            const __m128i exp_mask = _mm_set1_epi32(static_cast<int>(kExponentMask));
+            const __m128 minv = _mm_set1_ps(opts.min);
+            const __m128 maxv = _mm_set1_ps(opts.max);
+
+            const __m128i bits = _mm_or_si128(_mm_slli_epi32(raw, 16), _mm_srli_epi32(raw, 16));
+            __m128 value = _mm_castsi128_ps(bits);
+
+            const __m128 non_finite = _mm_castsi128_ps(
+                _mm_cmpeq_epi32(_mm_and_si128(bits, exp_mask), exp_mask));
+            const __m128 outside = _mm_andnot_ps(
+                non_finite, _mm_or_ps(_mm_cmplt_ps(value, minv), _mm_cmpgt_ps(value, maxv)));
+
+            non_finite_bits = static_cast<std::uint32_t>(_mm_movemask_ps(non_finite));
+            outside_bits = static_cast<std::uint32_t>(_mm_movemask_ps(outside));
+
+            if (opts.clamp)
+            {
+                // minps/maxps return the second operand on NaN: NaN survives the first
+                // step and becomes min in the second.
+                value = _mm_max_ps(_mm_min_ps(maxv, value), minv);
+            }
+            return value;
+        }
+
+        // Four values per step; a short tail takes one more step with the missing lanes zeroed.
+        std::size_t decode_sse2(const std::uint16_t *words,
+                                std::size_t count,
+                                float *out,
+                                const FloatDecodeOptions &opts,
+                                FloatDecodeReport &report) noexcept
+        {
+            std::uint32_t non_finite_bits = 0;
+            std::uint32_t outside_bits = 0;
+            std::uint32_t nf = 0;
+            std::uint32_t oor = 0;
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                const __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i *>(words + 2 * i));
+                _mm_storeu_ps(out + i, decode4_sse2(raw, opts, nf, oor));
+                non_finite_bits |= nf << i;
+                outside_bits |= oor << i;
+            }
+
+            const std::size_t rest = count - i;
+            if (rest > 0)
+            {
+                const __m128i raw = _mm_setr_epi32(static_cast<int>(tail_pair(words + 2 * i, 0, rest)),
+                                                   static_cast<int>(tail_pair(words + 2 * i, 1, rest)),
+                                                   static_cast<int>(tail_pair(words + 2 * i, 2, rest)),
+                                                   0);
+                float values[4];
+                _mm_storeu_ps(values, decode4_sse2(raw, opts, nf, oor));
+                for (std::size_t k = 0; k < rest; ++k)
+                {
+                    out[i + k] = values[k];
+                }
+                non_finite_bits |= (nf & low_lanes(rest)) << i;
+                outside_bits |= (oor & low_lanes(rest)) << i;
+            }
+
+            report.non_finite_mask |= non_finite_bits;
+            report.out_of_range_mask |= outside_bits;
+            return count;
+        }
+#endif
+
+#if defined(BMS_DECODE_AVX2)
+        /** @brief Eight values; same lane layout as the SSE2 step. */
+        inline __m256 decode8_avx2(__m256i raw,
+                                   const FloatDecodeOptions &opts,
+                                   std::uint32_t &non_finite_bits,
+                                   std::uint32_t &outside_bits) noexcept
+        {
+            const __m256i exp_mask = _mm256_set1_epi32(static_cast<int>(kExponentMask));
+            const __m256 minv = _mm256_set1_ps(opts.min);
+            const __m256 maxv = _mm256_set1_ps(opts.max);
+
+            const __m256i bits = _mm256_or_si256(_mm256_slli_epi32(raw, 16), _mm256_srli_epi32(raw, 16));
+            __m256 value = _mm256_castsi256_ps(bits);
+
+            const __m256 non_finite = _mm256_castsi256_ps(
+                _mm256_cmpeq_epi32(_mm256_and_si256(bits, exp_mask), exp_mask));
+            const __m256 outside = _mm256_andnot_ps(
+                non_finite,
+                _mm256_or_ps(_mm256_cmp_ps(value, minv, _CMP_LT_OQ), _mm256_cmp_ps(value, maxv, _CMP_GT_OQ)));
+
+            non_finite_bits = static_cast<std::uint32_t>(_mm256_movemask_ps(non_finite));
+            outside_bits = static_cast<std::uint32_t>(_mm256_movemask_ps(outside));
+
+            if (opts.clamp)
+            {
+                value = _mm256_max_ps(_mm256_min_ps(maxv, value), minv);
+            }
+            return value;
+        }
+
+        // Eight values per step; a short tail (e.g. a 7-float run) takes one masked step.
+        std::size_t decode_avx2(const std::uint16_t *words,
+                                std::size_t count,
+                                float *out,
+                                const FloatDecodeOptions &opts,
+                                FloatDecodeReport &report) noexcept
+        {
+            std::uint32_t non_finite_bits = 0;
+            std::uint32_t outside_bits = 0;
+            std::uint32_t nf = 0;
+            std::uint32_t oor = 0;
+            std::size_t i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                const __m256i raw = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words + 2 * i));
+                _mm256_storeu_ps(out + i, decode8_avx2(raw, opts, nf, oor));
+                non_finite_bits |= nf << i;
+                outside_bits |= oor << i;
+            }
+
+            const std::size_t rest = count - i;
+            if (rest > 0)
+            {
+                // Masked-off lanes neither load nor store, so the step never touches
+                // memory past the run.
+                const __m256i lanes = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(rest)),
+                                                         _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+                const __m256i raw = _mm256_maskload_epi32(reinterpret_cast<const int *>(words + 2 * i), lanes);
+                _mm256_maskstore_ps(out + i, lanes, decode8_avx2(raw, opts, nf, oor));
+                non_finite_bits |= (nf & low_lanes(rest)) << i;
+                outside_bits |= (oor & low_lanes(rest)) << i;
+            }
+
+            report.non_finite_mask |= non_finite_bits;
+            report.out_of_range_mask |= outside_bits;
+            return count;
+        }
+#endif
+
+#if defined(BMS_DECODE_NEON)
+        inline std::uint32_t neon_movemask(uint32x4_t lanes) noexcept
+        {
+            static const std::uint32_t kBits[4] = {1u, 2u, 4u, 8u};
+            const uint32x4_t picked = vandq_u32(lanes, vld1q_u32(kBits));
+            uint32x2_t sum = vpadd_u32(vget_low_u32(picked), vget_high_u32(picked));
+            sum = vpadd_u32(sum, sum);
+            return vget_lane_u32(sum, 0);
+        }
+
+        /** @brief Four values; vrev32q_u16 swaps the word halves of each lane. */
+        inline float32x4_t decode4_neon(uint16x8_t raw,
+                                        const FloatDecodeOptions &opts,
+                                        std::uint32_t &non_finite_bits,
+                                        std::uint32_t &outside_bits) noexcept
+        {
+            const uint32x4_t exp_mask = vdupq_n_u32(kExponentMask);
+            const float32x4_t minv = vdupq_n_f32(opts.min);
+            const float32x4_t maxv = vdupq_n_f32(opts.max);
+
+            const uint32x4_t bits = vreinterpretq_u32_u16(vrev32q_u16(raw));
+            float32x4_t value = vreinterpretq_f32_u32(bits);
+
+            const uint32x4_t non_finite = vceqq_u32(vandq_u32(bits, exp_mask), exp_mask);
+            const uint32x4_t outside = vbicq_u32(
+                vorrq_u32(vcltq_f32(value, minv), vcgtq_f32(value, maxv)), non_finite);
+
+            non_finite_bits = neon_movemask(non_finite);
+            outside_bits = neon_movemask(outside);
+
+            if (opts.clamp)
+            {
+                // ARMv7 vmin/vmax propagate NaN, so NaN lanes are replaced explicitly.
+                const uint32x4_t ordered = vceqq_f32(value, value);
+                value = vbslq_f32(ordered, vmaxq_f32(vminq_f32(value, maxv), minv), minv);
+            }
+            return value;
+        }
+
+        // Four values per step; a short tail takes one more step with the missing lanes zeroed.
+        std::size_t decode_neon(const std::uint16_t *words,
+                                std::size_t count,
+                                float *out,
+                                const FloatDecodeOptions &opts,
+                                FloatDecodeReport &report) noexcept
+        {
+            std::uint32_t non_finite_bits = 0;
+            std::uint32_t outside_bits = 0;
+            std::uint32_t nf = 0;
+            std::uint32_t oor = 0;
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                vst1q_f32(out + i, decode4_neon(vld1q_u16(words + 2 * i), opts, nf, oor));
+                non_finite_bits |= nf << i;
+                outside_bits |= oor << i;
+            }
+
+            const std::size_t rest = count - i;
+            if (rest > 0)
+            {
+                uint32x4_t pairs = vdupq_n_u32(0);
+                pairs = vsetq_lane_u32(tail_pair(words + 2 * i, 0, rest), pairs, 0);
+                pairs = vsetq_lane_u32(tail_pair(words + 2 * i, 1, rest), pairs, 1);
+                pairs = vsetq_lane_u32(tail_pair(words + 2 * i, 2, rest), pairs, 2);
+                float values[4];
+                vst1q_f32(values, decode4_neon(vreinterpretq_u16_u32(pairs), opts, nf, oor));
+                for (std::size_t k = 0; k < rest; ++k)
+                {
+                    out[i + k] = values[k];
+                }
+                non_finite_bits |= (nf & low_lanes(rest)) << i;
+                outside_bits |= (oor & low_lanes(rest)) << i;
+            }
+
+            report.non_finite_mask |= non_finite_bits;
+            report.out_of_range_mask |= outside_bits;
+            return count;
+        }
+#endif
+    } // namespace
+
+    FloatDecodeReport decode_float_words_scalar(const std::uint16_t *words,
+                                                std::size_t count,
+                                                float *out,
+                                                const FloatDecodeOptions &opts) noexcept
+    {
+        assert(count <= kMaxDecodeFloats);
+
+        FloatDecodeReport report;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            decode_one(words, i, out, opts, report);
+        }
+        return report;
+    }
+
+    FloatDecodeReport decode_float_words(const std::uint16_t *words,
+                                         std::size_t count,
+                                         float *out,
+                                         const FloatDecodeOptions &opts) noexcept
+    {
+        assert(count <= kMaxDecodeFloats);
+
+        FloatDecodeReport report;
+        std::size_t done = 0;
+
+        // The vector kernels rely on little-endian lane layout.
+        if constexpr (std::endian::native == std::endian::little)
+        {
+#if defined(BMS_DECODE_AVX2)
+            done = decode_avx2(words, count, out, opts, report);
+#elif defined(BMS_DECODE_SSE2)
+            done = decode_sse2(words, count, out, opts, report);
+#elif defined(BMS_DECODE_NEON)
+            done = decode_neon(words, count, out, opts, report);
+#endif
+        }
+
+        for (std::size_t i = done; i < count; ++i)
+        {
+            decode_one(words, i, out, opts, report);
+        }
+        return report;
+    }
+
+    const char *decode_kernel_name() noexcept
+    {
+#if defined(BMS_DECODE_AVX2)
+        return "avx2";
+#elif defined(BMS_DECODE_SSE2)
+        return "sse2";
+#elif defined(BMS_DECODE_NEON)
+        return "neon";
+#else
+        return "scalar";
+#endif
+    }
+
+} // namespace bms
@@ -0,0 +1,283 @@
+/**
+ * @file register_log.cpp
+ * @brief mmap-backed register block recorder and reader.
+ */
+
+#include "register_log.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+namespace bms
+{
+    namespace
+    {
+        constexpr char kLogMagic[8] = {'B', 'M', 'S', 'R', 'L', 'O', 'G', '1'};
+        constexpr std::uint32_t kLogVersion = 1;
+
+        std::int64_t to_ns(std::chrono::system_clock::time_point tp) noexcept
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+        }
+
+        std::chrono::system_clock::time_point from_ns(std::int64_t ns) noexcept
+        {
+            return std::chrono::system_clock::time_point(
+                std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(ns)));
+        }
+
+        std::string errno_message(const char *what)
+        {
+            return std::string(what) + ": " + std::strerror(errno);
+        }
+    } // namespace
+
+    RegisterLogRecord make_log_record(RecordSource source, std::uint64_t cycle, const TimedBlockRead &read) noexcept
+    {
+        RegisterLogRecord record{};
+        record.wall_started_ns = to_ns(read.wall_started);
+        record.wall_finished_ns = to_ns(read.wall_finished);
+        record.cycle = cycle;
+        record.source = static_cast<std::uint8_t>(source);
+        record.ok = read.ok ? 1 : 0;
+        record.skipped = read.skipped ? 1 : 0;
+        if (read.ok)
+        {
+            std::memcpy(record.regs, read.regs.data(), sizeof(record.regs));
+        }
+        return record;
+    }
+
+    TimedBlockRead to_block_read(const RegisterLogRecord &record) noexcept
+    {
+        TimedBlockRead read;
+        std::memcpy(read.regs.data(), record.regs, sizeof(record.regs));
+        read.wall_started = from_ns(record.wall_started_ns);
+        read.wall_finished = from_ns(record.wall_finished_ns);
+        read.started = std::chrono::steady_clock::time_point(
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::nanoseconds(record.wall_started_ns)));
+        read.finished = read.started + (read.wall_finished - read.wall_started);
+        read.ok = record.ok != 0;
+        read.skipped = record.skipped != 0;
+        return read;
+    }
+
+    // ============================================================================
+    // RegisterRecorder
+    // ============================================================================
+
+    RegisterRecorder::RegisterRecorder(std::string path, std::size_t grow_bytes)
+        : path_(std::move(path)),
+          grow_bytes_(std::max<std::size_t>(grow_bytes, sizeof(RegisterLogHeader) + sizeof(RegisterLogRecord)))
+    {
+    }
+
+    RegisterRecorder::~RegisterRecorder()
+    {
+        close();
+    }
+
+    bool RegisterRecorder::map_(std::size_t size)
+    {
+        if (::ftruncate(fd_, static_cast<off_t>(size)) != 0)
+        {
+            last_error_ = errno_message("ftruncate");
+            return false;
+        }
+        void *p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED)
+        {
+            last_error_ = errno_message("mmap");
+            return false;
+        }
+        base_ = static_cast<std::uint8_t *>(p);
+        mapped_ = size;
+        return true;
+    }
+
+    void RegisterRecorder::unmap_() noexcept
+    {
+        if (base_)
+        {
+            ::munmap(base_, mapped_);
+            base_ = nullptr;
+            mapped_ = 0;
+        }
+    }
+
+    bool RegisterRecorder::open()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (fd_ >= 0)
+        {
+            return true;
+        }
+
+        fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd_ < 0)
+        {
+            last_error_ = errno_message("open");
+            return false;
+        }
+        if (!map_(grow_bytes_))
+        {
+            ::close(fd_);
+            fd_ = -1;
+            return false;
+        }
+
+        RegisterLogHeader header{};
+        std::memcpy(header.magic, kLogMagic, sizeof(header.magic));
+        header.version = kLogVersion;
+        header.record_size = sizeof(RegisterLogRecord);
+        header.register_count = static_cast<std::uint32_t>(kRegisterBlockCount);
+        std::memcpy(base_, &header, sizeof(header));
+        count_ = 0;
+        return true;
+    }
+
+    void RegisterRecorder::close()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (fd_ < 0)
+        {
+            return;
+        }
+
+        unmap_();
+        // Drop the unused tail of the last chunk.
+        const auto used = sizeof(RegisterLogHeader) + count_ * sizeof(RegisterLogRecord);
+        if (::ftruncate(fd_, static_cast<off_t>(used)) != 0)
+        {
+            last_error_ = errno_message("ftruncate");
+        }
+        ::close(fd_);
+        fd_ = -1;
+    }
+
+    bool RegisterRecorder::append(RecordSource source, std::uint64_t cycle, const TimedBlockRead &read)
+    {
+        const RegisterLogRecord record = make_log_record(source, cycle, read);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (fd_ < 0)
+        {
+            return false;
+        }
+
+        const std::size_t offset = sizeof(RegisterLogHeader) + count_ * sizeof(RegisterLogRecord);
+        if (offset + sizeof(RegisterLogRecord) > mapped_)
+        {
+            const std::size_t grown = mapped_ + grow_bytes_;
+            unmap_();
+            if (!map_(grown))
+            {
+                // Keep what was recorded so far; further appends fail.
+                if (::ftruncate(fd_, static_cast<off_t>(offset)) != 0)
+                {
+                    last_error_ += "; " + errno_message("ftruncate");
+                }
+                ::close(fd_);
+                fd_ = -1;
+                return false;
+            }
+        }
+
+        std::memcpy(base_ + offset, &record, sizeof(record));
+        ++count_;
+        reinterpret_cast<RegisterLogHeader *>(base_)->record_count = count_;
+        return true;
+    }
+
+    std::uint64_t RegisterRecorder::records() const noexcept
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return count_;
+    }
+
+    // ============================================================================
+    // RegisterLogReader
+    // ============================================================================
+
+    RegisterLogReader::~RegisterLogReader()
+    {
+        close();
+    }
+
+    bool RegisterLogReader::open(const std::string &path)
+    {
+        close();
+
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            last_error_ = errno_message("open");
+            return false;
+        }
+
+        struct stat st{};
+        if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(RegisterLogHeader))
+        {
+            last_error_ = "not a register log (too short)";
+            ::close(fd);
+            return false;
+        }
+
+        const auto size = static_cast<std::size_t>(st.st_size);
+        void *p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED)
+        {
+            last_error_ = errno_message("mmap");
+            return false;
+        }
+        base_ = static_cast<const std::uint8_t *>(p);
+        size_ = size;
+
+        RegisterLogHeader header{};
+        std::memcpy(&header, base_, sizeof(header));
+        if (std::memcmp(header.magic, kLogMagic, sizeof(kLogMagic)) != 0 ||
+            header.version != kLogVersion ||
+            header.record_size != sizeof(RegisterLogRecord) ||
+            header.register_count != kRegisterBlockCount)
+        {
+            last_error_ = "not a register log (bad header)";
+            close();
+            return false;
+        }
+
+        // Trust the header count only as far as the file actually extends.
+        const std::size_t complete = (size_ - sizeof(RegisterLogHeader)) / sizeof(RegisterLogRecord);
+        count_ = static_cast<std::size_t>(std::min<std::uint64_t>(header.record_count, complete));
+        return true;
+    }
+
+    void RegisterLogReader::close() noexcept
+    {
+        if (base_)
+        {
+            ::munmap(const_cast<std::uint8_t *>(base_), size_);
+            base_ = nullptr;
+            size_ = 0;
+            count_ = 0;
+        }
+    }
+
+    std::span<const RegisterLogRecord> RegisterLogReader::records() const noexcept
+    {
+        if (!base_)
+        {
+            return {};
+        }
+        return {reinterpret_cast<const RegisterLogRecord *>(base_ + sizeof(RegisterLogHeader)), count_};
+    }
+
+} // namespace bms
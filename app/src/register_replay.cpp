@@ -0,0 +1,126 @@
+/**
+ * @file register_replay.cpp
+ * @brief Paced replay of register logs into the acquisition tasks.
+ */
+
+#include "register_replay.hpp"
+
+#include <boost/chrono.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace bms
+{
+    namespace
+    {
+        // Temperature records may land between the two halves of a voltage cycle.
+        constexpr std::size_t kPairLookahead = 8;
+    } // namespace
+
+    RegisterLogReplay::RegisterLogReplay(RegisterReplayConfig cfg,
+                                         VoltageCurrentAcquisition *voltage_current,
+                                         TemperatureAcquisition *temperature)
+        : cfg_(std::move(cfg)), voltage_current_(voltage_current), temperature_(temperature)
+    {
+    }
+
+    bool RegisterLogReplay::open()
+    {
+        return reader_.open(cfg_.path);
+    }
+
+    void RegisterLogReplay::operator()()
+    {
+        const auto records = reader_.records();
+        const auto started = boost::chrono::steady_clock::now();
+        std::vector<bool> consumed(records.size(), false);
+
+        const auto wait_for = [&](const RegisterLogRecord &record) {
+            if (cfg_.speed <= 0.0)
+            {
+                return;
+            }
+            // Release each record at its recorded offset, scaled by the replay speed.
+            const double offset_s =
+                static_cast<double>(record.wall_started_ns - records.front().wall_started_ns) * 1e-9 / cfg_.speed;
+            const auto due = started + boost::chrono::duration_cast<boost::chrono::steady_clock::duration>(
+                                           boost::chrono::duration<double>(std::max(0.0, offset_s)));
+            boost::this_thread::sleep_until(due);
+        };
+
+        for (std::size_t i = 0; i < records.size() && !stop_requested_.load(); ++i)
+        {
+            if (consumed[i])
+            {
+                continue;
+            }
+            const RegisterLogRecord &record = records[i];
+            diagnostics_.records.fetch_add(1);
+
+            switch (static_cast<RecordSource>(record.source))
+            {
+            case RecordSource::Temperature:
+                if (temperature_)
+                {
+                    wait_for(record);
+                    temperature_->ingest(to_block_read(record));
+                    diagnostics_.temperature_cycles.fetch_add(1);
+                }
+                break;
+
+            case RecordSource::VoltageDevice1:
+            case RecordSource::VoltageDevice2:
+            {
+                if (!voltage_current_)
+                {
+                    break;
+                }
+
+                // Find the other half of this cycle a few records ahead.
+                const auto partner_source = record.source == static_cast<std::uint8_t>(RecordSource::VoltageDevice1)
+                                                ? RecordSource::VoltageDevice2
+                                                : RecordSource::VoltageDevice1;
+                std::size_t partner = records.size();
+                for (std::size_t j = i + 1; j < records.size() && j <= i + kPairLookahead; ++j)
+                {
+                    if (!consumed[j] &&
+                        records[j].cycle == record.cycle &&
+                        records[j].source == static_cast<std::uint8_t>(partner_source))
+                    {
+                        partner = j;
+                        break;
+                    }
+                }
+                if (partner == records.size())
+                {
+                    diagnostics_.unpaired_records.fetch_add(1);
+                    break;
+                }
+                consumed[partner] = true;
+                diagnostics_.records.fetch_add(1);
+
+                const bool first_is_device1 = partner_source == RecordSource::VoltageDevice2;
+                const RegisterLogRecord &device1 = first_is_device1 ? record : records[partner];
+                const RegisterLogRecord &device2 = first_is_device1 ? records[partner] : record;
+
+                wait_for(record);
+                voltage_current_->ingest(to_block_read(device1), to_block_read(device2));
+                diagnostics_.voltage_cycles.fetch_add(1);
+                break;
+            }
+
+            default:
+                break;
+            }
+        }
+
+        diagnostics_.elapsed_ms.store(boost::chrono::duration_cast<boost::chrono::milliseconds>(
+                                          boost::chrono::steady_clock::now() - started)
+                                          .count());
+        diagnostics_.finished.store(true);
+    }
+
+} // namespace bms
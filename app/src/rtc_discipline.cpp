@@ -0,0 +1,127 @@
+/**
+ * @file rtc_discipline.cpp
+ * @brief Device RTC correction from estimated clock offsets.
+ */
+
+#include "rtc_discipline.hpp"
+
+#include <array>
+#include <cstdlib>
+#include <utility>
+
+namespace bms
+{
+    RtcDiscipline::RtcDiscipline(RtcDisciplineConfig cfg) noexcept
+        : cfg_(std::move(cfg))
+    {
+    }
+
+    bool RtcDiscipline::due_(const ClockOffsetEstimator &estimator, clock::time_point now)
+    {
+        if (attempted_ &&
+            std::chrono::steady_clock::now() - last_attempt_ < std::chrono::seconds(cfg_.min_interval_s))
+        {
+            return false;
+        }
+        if (!estimator.valid())
+        {
+            return false;
+        }
+
+        const ClockEstimate estimate = estimator.estimate(now);
+        if (estimate.uncertainty_us > cfg_.max_uncertainty_ms * 1000)
+        {
+            return false;
+        }
+        return std::llabs(estimate.offset_us) > cfg_.threshold_ms * 1000;
+    }
+
+    bool RtcDiscipline::write_time_(ModbusTcpClient &device, clock::time_point arrival, bool round_to_nearest)
+    {
+        const auto since_2000 = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                    arrival - clock::from_time_t(kUnixEpoch2000))
+                                    .count();
+        if (since_2000 < 0)
+        {
+            return false;
+        }
+
+        auto seconds = static_cast<std::uint32_t>(since_2000 / 1000);
+        const auto millis = static_cast<std::uint16_t>(since_2000 % 1000);
+        if (round_to_nearest && millis >= 500)
+        {
+            ++seconds;
+        }
+
+        // Same layout as the read side: epoch hi, epoch lo, then ms in the next register.
+        const std::array<std::uint16_t, 3> words{
+            static_cast<std::uint16_t>(seconds >> 16),
+            static_cast<std::uint16_t>(seconds & 0xFFFFu),
+            millis};
+        return device.write_registers(cfg_.epoch_register, cfg_.write_milliseconds ? 3 : 2, words.data());
+    }
+
+    bool RtcDiscipline::maybe_correct(ModbusTcpClient &device, ClockOffsetEstimator &estimator)
+    {
+        if (!cfg_.enabled)
+        {
+            return false;
+        }
+
+        const auto now = clock::now();
+        if (!due_(estimator, now))
+        {
+            armed_ = false;
+            return false;
+        }
+        if (device.circuit_state() != CircuitState::Closed)
+        {
+            return false;
+        }
+
+        // The device applies the value when the request arrives, about half an RTT from now.
+        const auto one_way = std::chrono::microseconds(device.rtt_histogram().percentile(0.5) / 2);
+        const auto steady_now = std::chrono::steady_clock::now();
+
+        bool round_to_nearest = false;
+        if (!cfg_.write_milliseconds)
+        {
+            if (!armed_)
+            {
+                armed_ = true;
+                armed_since_ = steady_now;
+            }
+
+            const auto arrival_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                        (clock::now() + one_way).time_since_epoch())
+                                        .count();
+            if (arrival_ms % 1000 >= cfg_.phase_window_ms)
+            {
+                if (steady_now - armed_since_ < std::chrono::seconds(cfg_.max_phase_wait_s))
+                {
+                    return false;
+                }
+                // The cycle period keeps missing the window: settle for +/- 500 ms.
+                round_to_nearest = true;
+            }
+        }
+
+        armed_ = false;
+        attempted_ = true;
+        last_attempt_ = steady_now;
+
+        const std::int64_t offset_us = estimator.estimate(now).offset_us;
+        if (!write_time_(device, clock::now() + one_way, round_to_nearest))
+        {
+            status_.write_failures++;
+            return false;
+        }
+
+        // The device clock stepped; its history no longer describes the new clock.
+        estimator.reset();
+        status_.corrections++;
+        status_.last_corrected_offset_us = offset_us;
+        return true;
+    }
+
+} // namespace bms
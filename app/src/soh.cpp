@@ -5,8 +5,9 @@
 
 #include "soh.hpp"
 
-#include <chrono>
+#include <array>
 #include <iostream>
+#include <optional>
 #include <utility>
 
 namespace bms
@@ -14,80 +15,75 @@ namespace bms
     SoHTask::SoHTask(SoHTaskConfig cfg, VoltageQueue &voltage_queue, TemperatureQueue &temperature_queue)
         : cfg_(std::move(cfg)), voltage_queue_(voltage_queue), temperature_queue_(temperature_queue)
     {
+        (void)selector_.add(voltage_queue_);
+        temperature_source_ = selector_.add(temperature_queue_);
     }
 
     void SoHTask::operator()()
     {
-        VoltageCurrentSample *vc_ptr = nullptr;
-        TemperatureSample *temp_ptr = nullptr;
+        std::array<VoltageCurrentSample, kDrainBatch> vc_batch{};
 
-        while (true)
+        // Sleep until either queue has data; the selector gives up once both are closed and drained.
+        while (const std::optional<std::size_t> ready = selector_.wait())
         {
-            // Wait primarily on voltage/current cadence while opportunistically draining temperature.
-            bool got_voltage = false;
-            if (voltage_queue_.try_pop(vc_ptr))
+            // Update latest temperature context before processing any voltage samples.
+            refresh_temperature_();
+            if (*ready == temperature_source_)
             {
-                got_voltage = true;
+                continue;
             }
-            else
-            {
-                if (voltage_queue_.is_closed() && temperature_queue_.is_closed())
-                {
-                    break;
-                }
 
-                got_voltage = voltage_queue_.wait_for_and_pop(vc_ptr, std::chrono::milliseconds(250));
-                if (!got_voltage)
+            // Process voltage samples in FIFO order with most recent temperature context.
+            std::size_t n = 0;
+            do
+            {
+                n = voltage_queue_.pop_bulk(vc_batch);
+                for (std::size_t i = 0; i < n; ++i)
                 {
-                    // Keep only the latest temperature snapshot between voltage frames.
-                    while (temperature_queue_.try_pop(temp_ptr))
-                    {
-                        latest_temperature_ = *temp_ptr;
-                        diag_.last_temperature_sequence = temp_ptr->sequence;
-                        temperature_queue_.dispose(temp_ptr);
-                        temp_ptr = nullptr;
-                    }
-                    continue;
+                    consume_voltage_(vc_batch[i]);
                 }
-            }
+            } while (n == vc_batch.size());
+        }
+    }
 
-            // Update latest temperature context before processing the current voltage sample.
-            while (temperature_queue_.try_pop(temp_ptr))
+    void SoHTask::refresh_temperature_()
+    {
+        // Keep only the latest temperature snapshot between voltage frames.
+        std::array<TemperatureSample, kDrainBatch> temp_batch{};
+        std::size_t n = 0;
+        do
+        {
+            n = temperature_queue_.pop_bulk(temp_batch);
+            if (n > 0)
             {
-                latest_temperature_ = *temp_ptr;
-                diag_.last_temperature_sequence = temp_ptr->sequence;
-                temperature_queue_.dispose(temp_ptr);
-                temp_ptr = nullptr;
+                latest_temperature_ = temp_batch[n - 1];
+                diag_.last_temperature_sequence = temp_batch[n - 1].sequence;
             }
+        } while (n == temp_batch.size());
+    }
 
-            if (vc_ptr != nullptr)
-            {
-                // Process voltage sample in FIFO order with most recent temperature context.
-                diag_.frames_observed += 1;
-                diag_.last_voltage_sequence = vc_ptr->sequence;
-
-                if (latest_temperature_.has_value())
-                {
-                    diag_.frames_with_both_measurements += 1;
-                }
+    void SoHTask::consume_voltage_(const VoltageCurrentSample &sample)
+    {
+        diag_.frames_observed += 1;
+        diag_.last_voltage_sequence = sample.sequence;
 
-                if (cfg_.enable_diagnostics_logging)
-                {
-                    std::cout << "[SoH][interface] consumed vc_seq=" << vc_ptr->sequence;
-                    if (latest_temperature_.has_value())
-                    {
-                        std::cout << " temp_seq=" << latest_temperature_->sequence;
-                    }
-                    else
-                    {
-                        std::cout << " temp_seq=none";
-                    }
-                    std::cout << std::endl;
-                }
+        if (latest_temperature_.has_value())
+        {
+            diag_.frames_with_both_measurements += 1;
+        }
 
-                voltage_queue_.dispose(vc_ptr);
-                vc_ptr = nullptr;
+        if (cfg_.enable_diagnostics_logging)
+        {
+            std::cout << "[SoH][interface] consumed vc_seq=" << sample.sequence;
+            if (latest_temperature_.has_value())
+            {
+                std::cout << " temp_seq=" << latest_temperature_->sequence;
+            }
+            else
+            {
+                std::cout << " temp_seq=none";
             }
+            std::cout << std::endl;
         }
     }
 
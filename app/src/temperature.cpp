@@ -5,6 +5,8 @@
 
 #include "temperature.hpp"
 
+#include "register_map.hpp"
+
 #include <boost/chrono.hpp>
 
 #include <algorithm>
@@ -17,7 +19,7 @@
 namespace bms
 {
     TemperatureAcquisition::TemperatureAcquisition(TemperatureAcquisitionConfig cfg)
-        : cfg_(std::move(cfg)), device_(cfg_.device)
+        : cfg_(std::move(cfg)), device_(cfg_.device), clock_(cfg_.clock_estimator), rtc_(cfg_.rtc)
     {
     }
 
@@ -31,15 +33,6 @@ namespace bms
         device_.disconnect();
     }
 
-    float TemperatureAcquisition::decode_channel_(
-        const std::array<std::uint16_t, kRegisterBlockCount> &regs,
-        std::size_t channel_index) noexcept
-    {
-        const std::size_t hi = 3 + (2 * channel_index);
-        const std::size_t lo = hi + 1;
-        return modbus_registers_to_float(regs[hi], regs[lo]);
-    }
-
     std::string TemperatureAcquisition::format_timestamp_(std::chrono::system_clock::time_point tp)
     {
         const auto time = std::chrono::system_clock::to_time_t(tp);
@@ -79,6 +72,7 @@ namespace bms
         std::cout << "[Temperature] seq=" << sequence_
                   << " temp_ok=0"
                   << " err=\"" << device_.status().last_error << "\""
+                  << " circuit=" << to_string(device_.circuit_state())
                   << std::endl;
     }
 
@@ -96,7 +90,20 @@ namespace bms
                   << " success=" << successes
                   << " failures=" << failures
                   << " success_rate_pct=" << std::fixed << std::setprecision(1) << success_rate
+                  << " skipped=" << diagnostics_.skipped.load()
+                  << " circuit_opens=" << device_.status().circuit_opens
                   << " cycle_ms=" << diagnostics_.last_cycle_duration_ms.load()
+                  << " rtt_p50_us=" << device_.status().rtt.p50_us
+                  << " rtt_p99_us=" << device_.status().rtt.p99_us
+                  << " timeout_ms=" << device_.status().response_timeout_ms
+                  << " kernel_rx=" << device_.status().kernel_rx_timestamps
+                  << " resyncs=" << device_.status().stream_resyncs
+                  << " clock_offset_us=" << diagnostics_.clock_offset_us.load()
+                  << " clock_drift_ppb=" << diagnostics_.clock_drift_ppb.load()
+                  << " clock_unc_us=" << diagnostics_.clock_uncertainty_us.load()
+                  << " host_time_fallbacks=" << diagnostics_.host_time_fallbacks.load()
+                  << " rtc_corrections=" << diagnostics_.rtc_corrections.load()
+                  << " rtc_write_failures=" << diagnostics_.rtc_write_failures.load()
                   << std::defaultfloat
                   << std::endl;
     }
@@ -106,22 +113,104 @@ namespace bms
         // Measure end-to-end cycle latency for diagnostics.
         const auto cycle_start = boost::chrono::steady_clock::now();
 
-        diagnostics_.attempts.fetch_add(1);
-
         // Read the canonical register block and decode all channels when successful.
-        std::array<std::uint16_t, kRegisterBlockCount> regs{};
-        const bool read_ok = device_.read_bms_block(regs);
+        static_assert(TemperatureBoardMap::kRegisterCount == kRegisterBlockCount);
+        TimedBlockRead read;
+        read.started = std::chrono::steady_clock::now();
+        read.wall_started = std::chrono::system_clock::now();
+        read.ok = device_.read_register_map<TemperatureBoardMap>(read.regs);
+        read.skipped = device_.last_read_skipped();
+        read.wall_finished = std::chrono::system_clock::now();
+        read.finished = std::chrono::steady_clock::now();
+        if (read.ok)
+        {
+            // Request write to response arrival (kernel-stamped when enabled).
+            read.wall_started = device_.last_exchange().sent;
+            read.wall_finished = device_.last_exchange().received;
+        }
 
-        if (read_ok)
+        if (recorder_)
+        {
+            recorder_->append(RecordSource::Temperature, sequence_, read);
+        }
+
+        process_cycle_(read);
+
+        // RTC corrections go after the sample is delivered so they never delay it.
+        if (read.ok)
+        {
+            const auto failures_before = rtc_.status().write_failures;
+            if (rtc_.maybe_correct(device_, clock_))
+            {
+                diagnostics_.rtc_corrections.fetch_add(1);
+                std::cout << "[Temperature] rtc_corrected offset_us="
+                          << rtc_.status().last_corrected_offset_us << std::endl;
+            }
+            else if (rtc_.status().write_failures != failures_before)
+            {
+                diagnostics_.rtc_write_failures.fetch_add(1);
+                std::cout << "[Temperature] rtc_write_failed err=\""
+                          << device_.status().last_error << "\"" << std::endl;
+            }
+        }
+
+        const auto cycle_end = boost::chrono::steady_clock::now();
+        const auto cycle_duration = boost::chrono::duration_cast<boost::chrono::milliseconds>(
+            cycle_end - cycle_start);
+        diagnostics_.last_cycle_duration_ms.store(cycle_duration.count());
+
+        log_diagnostics_if_due_();
+    }
+
+    void TemperatureAcquisition::ingest(const TimedBlockRead &read)
+    {
+        process_cycle_(read);
+        log_diagnostics_if_due_();
+    }
+
+    void TemperatureAcquisition::log_diagnostics_if_due_()
+    {
+        // Emit summary diagnostics at configured cycle intervals.
+        if (cfg_.diagnostics_every_cycles > 0 &&
+            (sequence_ % cfg_.diagnostics_every_cycles) == 0)
+        {
+            log_diagnostics_();
+        }
+    }
+
+    void TemperatureAcquisition::process_cycle_(const TimedBlockRead &read)
+    {
+        diagnostics_.attempts.fetch_add(1);
+
+        const auto &regs = read.regs;
+        if (read.ok)
         {
             TemperatureSample sample;
-            sample.timestamp = std::chrono::system_clock::now();
             sample.sequence = sequence_;
-            float temp = 0;
-            for (std::size_t i = 0; i < kChannelCount; ++i)
+
+            // Stamp with the device's sampling instant mapped to host time.
+            const DeviceTimestamp device_ts = decode_device_timestamp(regs);
+            const HostTimestamp stamp = clock_.stamp(device_ts, read.wall_started, read.wall_finished);
+            sample.timestamp = stamp.time;
+            sample.time_uncertainty_us = stamp.uncertainty_us;
+            if (!stamp.from_device_clock)
+            {
+                diagnostics_.host_time_fallbacks.fetch_add(1);
+            }
+
+            const ClockEstimate estimate = clock_.estimate(read.wall_finished);
+            diagnostics_.clock_offset_us.store(estimate.offset_us);
+            diagnostics_.clock_drift_ppb.store(estimate.drift_ppb);
+            diagnostics_.clock_uncertainty_us.store(estimate.uncertainty_us);
+
+            // Decode all channels in one pass; negative and NaN readings clamp to 0 C.
+            FloatDecodeOptions decode_opts;
+            decode_opts.min = 0.0F;
+            decode_opts.clamp = true;
+            sample.flags = decode_register_map<TemperatureBoardMap>(regs, sample.temperatures, decode_opts).flags();
+            if (!device_ts.valid)
             {
-                temp = decode_channel_(regs, i); 
-                sample.temperatures[i] = temp > 0 ? temp : 0;
+                sample.flags = sample.flags | SampleFlags::TimestampInvalid;
             }
 
             diagnostics_.successes.fetch_add(1);
@@ -139,6 +228,10 @@ namespace bms
         else
         {
             diagnostics_.failures.fetch_add(1);
+            if (read.skipped)
+            {
+                diagnostics_.skipped.fetch_add(1);
+            }
             if (cfg_.enable_sample_logging)
             {
                 log_failure_();
@@ -147,18 +240,6 @@ namespace bms
 
         // Advance sequence even on failed reads to preserve attempt chronology.
         ++sequence_;
-
-        const auto cycle_end = boost::chrono::steady_clock::now();
-        const auto cycle_duration = boost::chrono::duration_cast<boost::chrono::milliseconds>(
-            cycle_end - cycle_start);
-        diagnostics_.last_cycle_duration_ms.store(cycle_duration.count());
-
-        // Emit summary diagnostics at configured cycle intervals.
-        if (cfg_.diagnostics_every_cycles > 0 &&
-            (sequence_ % cfg_.diagnostics_every_cycles) == 0)
-        {
-            log_diagnostics_();
-        }
     }
 
 } // namespace bms
@@ -5,8 +5,11 @@
 
 #include "voltage_current.hpp"
 
+#include "register_map.hpp"
+
 #include <boost/chrono.hpp>
 
+#include <algorithm>
 #include <ctime>
 #include <iomanip>
 #include <iostream>
@@ -20,8 +23,26 @@ namespace bms
         : cfg_(std::move(cfg)),
           dev1_(cfg_.device1),
           dev2_(cfg_.device2),
-          converter_(cfg_.current_scale_a_per_v, cfg_.current_offset_a)
+          converter_(cfg_.current_scale_a_per_v, cfg_.current_offset_a),
+          clock1_(cfg_.clock_estimator),
+          clock2_(cfg_.clock_estimator),
+          rtc1_(cfg_.rtc),
+          rtc2_(cfg_.rtc)
     {
+        dev2_thread_ = boost::thread(&VoltageCurrentAcquisition::device2_reader_loop_, this);
+    }
+
+    VoltageCurrentAcquisition::~VoltageCurrentAcquisition()
+    {
+        {
+            std::lock_guard<std::mutex> lock(dev2_mutex_);
+            dev2_stop_ = true;
+        }
+        dev2_cv_.notify_all();
+        if (dev2_thread_.joinable())
+        {
+            dev2_thread_.join();
+        }
     }
 
     bool VoltageCurrentAcquisition::connect()
@@ -37,13 +58,77 @@ namespace bms
         dev2_.disconnect();
     }
 
-    float VoltageCurrentAcquisition::decode_channel_(
-        const std::array<std::uint16_t, kRegisterBlockCount> &regs,
-        std::size_t channel_index) noexcept
+    void VoltageCurrentAcquisition::timed_read_(ModbusTcpClient &device, TimedBlockRead &out)
     {
-        const std::size_t hi = 3 + (2 * channel_index);
-        const std::size_t lo = hi + 1;
-        return modbus_registers_to_float(regs[hi], regs[lo]);
+        out.started = std::chrono::steady_clock::now();
+        out.wall_started = std::chrono::system_clock::now();
+        // Both boards share one block geometry, so either map describes the read.
+        static_assert(VoltageBoardAMap::kStartAddress == VoltageBoardBMap::kStartAddress &&
+                      VoltageBoardAMap::kRegisterCount == VoltageBoardBMap::kRegisterCount &&
+                      VoltageBoardAMap::kFunction == VoltageBoardBMap::kFunction);
+        out.ok = device.read_register_map<VoltageBoardAMap>(out.regs);
+        out.skipped = device.last_read_skipped();
+        out.wall_finished = std::chrono::system_clock::now();
+        out.finished = std::chrono::steady_clock::now();
+        if (out.ok)
+        {
+            // Tighter bounds for clock estimation: request write to response arrival
+            // (kernel-stamped when enabled), excluding retries, queuing and decode.
+            out.wall_started = device.last_exchange().sent;
+            out.wall_finished = device.last_exchange().received;
+        }
+    }
+
+    void VoltageCurrentAcquisition::export_clock_(const ClockOffsetEstimator &clock,
+                                                  std::atomic<std::int64_t> &offset_us,
+                                                  std::atomic<std::int64_t> &drift_ppb,
+                                                  std::atomic<std::int64_t> &uncertainty_us)
+    {
+        const ClockEstimate estimate = clock.estimate();
+        offset_us.store(estimate.offset_us);
+        drift_ppb.store(estimate.drift_ppb);
+        uncertainty_us.store(estimate.uncertainty_us);
+    }
+
+    void VoltageCurrentAcquisition::start_device2_read_()
+    {
+        {
+            std::lock_guard<std::mutex> lock(dev2_mutex_);
+            ++dev2_requested_;
+        }
+        dev2_cv_.notify_all();
+    }
+
+    void VoltageCurrentAcquisition::wait_device2_read_()
+    {
+        std::unique_lock<std::mutex> lock(dev2_mutex_);
+        dev2_cv_.wait(lock, [this] { return dev2_completed_ == dev2_requested_; });
+    }
+
+    void VoltageCurrentAcquisition::device2_reader_loop_()
+    {
+        std::unique_lock<std::mutex> lock(dev2_mutex_);
+        while (true)
+        {
+            dev2_cv_.wait(lock, [this] { return dev2_stop_ || dev2_requested_ != dev2_completed_; });
+            if (dev2_stop_)
+            {
+                // Release any cycle still waiting so shutdown never deadlocks the producer.
+                dev2_result_.ok = false;
+                dev2_completed_ = dev2_requested_;
+                dev2_cv_.notify_all();
+                return;
+            }
+
+            // Perform the blocking read outside the lock; dev2_result_ is owned by this
+            // thread until the completion generation is published.
+            lock.unlock();
+            timed_read_(dev2_, dev2_result_);
+            lock.lock();
+
+            dev2_completed_ = dev2_requested_;
+            dev2_cv_.notify_all();
+        }
     }
 
     std::string VoltageCurrentAcquisition::format_timestamp_(std::chrono::system_clock::time_point tp)
@@ -69,6 +154,7 @@ namespace bms
                   << " pair_ok=1"
                   << " raw_current_sensor_v=" << sample.raw_current_sensor_v
                   << " current_a=" << sample.current_a
+                  << " skew_us=" << sample.device_skew_us
                   << " cells={"
                   << "c1=" << sample.cell_voltages[0]
                   << ", c8=" << sample.cell_voltages[7]
@@ -87,12 +173,14 @@ namespace bms
 
         if (!dev1_ok)
         {
-            std::cout << " d1_err=\"" << dev1_.status().last_error << "\"";
+            std::cout << " d1_err=\"" << dev1_.status().last_error << "\""
+                      << " d1_circuit=" << to_string(dev1_.circuit_state());
         }
 
         if (!dev2_ok)
         {
-            std::cout << " d2_err=\"" << dev2_.status().last_error << "\"";
+            std::cout << " d2_err=\"" << dev2_.status().last_error << "\""
+                      << " d2_circuit=" << to_string(dev2_.circuit_state());
         }
 
         std::cout << std::endl;
@@ -111,28 +199,137 @@ namespace bms
         std::cout << "[VoltageCurrent][diag] attempts=" << attempts
                   << " success=" << successes
                   << " failures=" << failures
+                  << " partial=" << diagnostics_.partial_samples.load()
                   << " success_rate_pct=" << std::fixed << std::setprecision(1) << success_rate
                   << " d1_ok=" << diagnostics_.device1_successes.load()
                   << " d1_fail=" << diagnostics_.device1_failures.load()
                   << " d2_ok=" << diagnostics_.device2_successes.load()
                   << " d2_fail=" << diagnostics_.device2_failures.load()
+                  << " d1_skipped=" << diagnostics_.device1_skipped.load()
+                  << " d2_skipped=" << diagnostics_.device2_skipped.load()
+                  << " d1_circuit_opens=" << dev1_.status().circuit_opens
+                  << " d2_circuit_opens=" << dev2_.status().circuit_opens
                   << " cycle_ms=" << diagnostics_.last_cycle_duration_ms.load()
+                  << " skew_us=" << diagnostics_.last_device_skew_us.load()
+                  << " d1_clock_offset_us=" << diagnostics_.device1_clock_offset_us.load()
+                  << " d1_clock_drift_ppb=" << diagnostics_.device1_clock_drift_ppb.load()
+                  << " d1_clock_unc_us=" << diagnostics_.device1_clock_uncertainty_us.load()
+                  << " d2_clock_offset_us=" << diagnostics_.device2_clock_offset_us.load()
+                  << " d2_clock_drift_ppb=" << diagnostics_.device2_clock_drift_ppb.load()
+                  << " d2_clock_unc_us=" << diagnostics_.device2_clock_uncertainty_us.load()
+                  << " host_time_fallbacks=" << diagnostics_.host_time_fallbacks.load()
+                  << " d1_rtc_corrections=" << diagnostics_.device1_rtc_corrections.load()
+                  << " d2_rtc_corrections=" << diagnostics_.device2_rtc_corrections.load()
+                  << " rtc_write_failures=" << diagnostics_.rtc_write_failures.load()
+                  << " d1_rtt_p50_us=" << dev1_.status().rtt.p50_us
+                  << " d1_rtt_p99_us=" << dev1_.status().rtt.p99_us
+                  << " d1_timeout_ms=" << dev1_.status().response_timeout_ms
+                  << " d2_rtt_p50_us=" << dev2_.status().rtt.p50_us
+                  << " d2_rtt_p99_us=" << dev2_.status().rtt.p99_us
+                  << " d2_timeout_ms=" << dev2_.status().response_timeout_ms
+                  << " d1_kernel_rx=" << dev1_.status().kernel_rx_timestamps
+                  << " d2_kernel_rx=" << dev2_.status().kernel_rx_timestamps
+                  << " d1_resyncs=" << dev1_.status().stream_resyncs
+                  << " d2_resyncs=" << dev2_.status().stream_resyncs
                   << std::defaultfloat
                   << std::endl;
     }
 
+    void VoltageCurrentAcquisition::discipline_clocks_(bool dev1_ok, bool dev2_ok)
+    {
+        // Runs between cycles: the companion reader is idle, so dev2_ is safe to use here.
+        const auto discipline = [](RtcDiscipline &rtc,
+                                   ModbusTcpClient &device,
+                                   ClockOffsetEstimator &clock,
+                                   std::atomic<std::uint64_t> &corrections,
+                                   std::atomic<std::uint64_t> &failures,
+                                   int index) {
+            const auto failures_before = rtc.status().write_failures;
+            if (rtc.maybe_correct(device, clock))
+            {
+                corrections.fetch_add(1);
+                std::cout << "[VoltageCurrent] rtc_corrected device=" << index
+                          << " offset_us=" << rtc.status().last_corrected_offset_us
+                          << std::endl;
+            }
+            else if (rtc.status().write_failures != failures_before)
+            {
+                failures.fetch_add(1);
+                std::cout << "[VoltageCurrent] rtc_write_failed device=" << index
+                          << " err=\"" << device.status().last_error << "\""
+                          << std::endl;
+            }
+        };
+
+        if (dev1_ok)
+        {
+            discipline(rtc1_, dev1_, clock1_,
+                       diagnostics_.device1_rtc_corrections, diagnostics_.rtc_write_failures, 1);
+        }
+        if (dev2_ok)
+        {
+            discipline(rtc2_, dev2_, clock2_,
+                       diagnostics_.device2_rtc_corrections, diagnostics_.rtc_write_failures, 2);
+        }
+    }
+
     void VoltageCurrentAcquisition::operator()()
     {
         // Measure cycle latency for periodic diagnostics.
         const auto cycle_start = boost::chrono::steady_clock::now();
 
+        // Read one full register block from each voltage/current endpoint concurrently:
+        // device 2 on the companion reader thread, device 1 on this thread.
+        TimedBlockRead read1;
+        start_device2_read_();
+        timed_read_(dev1_, read1);
+        wait_device2_read_();
+        const TimedBlockRead &read2 = dev2_result_;
+
+        if (recorder_)
+        {
+            recorder_->append(RecordSource::VoltageDevice1, sequence_, read1);
+            recorder_->append(RecordSource::VoltageDevice2, sequence_, read2);
+        }
+
+        process_cycle_(read1, read2);
+
+        // RTC corrections go after the sample is delivered so they never delay it.
+        discipline_clocks_(read1.ok, read2.ok);
+
+        const auto cycle_end = boost::chrono::steady_clock::now();
+        const auto cycle_duration = boost::chrono::duration_cast<boost::chrono::milliseconds>(
+            cycle_end - cycle_start);
+        diagnostics_.last_cycle_duration_ms.store(cycle_duration.count());
+
+        log_diagnostics_if_due_();
+    }
+
+    void VoltageCurrentAcquisition::ingest(const TimedBlockRead &read1, const TimedBlockRead &read2)
+    {
+        process_cycle_(read1, read2);
+        log_diagnostics_if_due_();
+    }
+
+    void VoltageCurrentAcquisition::log_diagnostics_if_due_()
+    {
+        // Emit aggregated diagnostics at configured cycle intervals.
+        if (cfg_.diagnostics_every_cycles > 0 &&
+            (sequence_ % cfg_.diagnostics_every_cycles) == 0)
+        {
+            log_diagnostics_();
+        }
+    }
+
+    void VoltageCurrentAcquisition::process_cycle_(const TimedBlockRead &read1, const TimedBlockRead &read2)
+    {
         diagnostics_.pair_attempts.fetch_add(1);
 
-        // Read one full register block from each voltage/current endpoint.
-        std::array<std::uint16_t, kRegisterBlockCount> regs1{};
-        std::array<std::uint16_t, kRegisterBlockCount> regs2{};
+        const auto &regs1 = read1.regs;
+        const auto &regs2 = read2.regs;
+        const bool dev1_ok = read1.ok;
+        const bool dev2_ok = read2.ok;
 
-        const bool dev1_ok = dev1_.read_bms_block(regs1);
         if (dev1_ok)
         {
             diagnostics_.device1_successes.fetch_add(1);
@@ -140,9 +337,12 @@ namespace bms
         else
         {
             diagnostics_.device1_failures.fetch_add(1);
+            if (read1.skipped)
+            {
+                diagnostics_.device1_skipped.fetch_add(1);
+            }
         }
 
-        const bool dev2_ok = dev2_.read_bms_block(regs2);
         if (dev2_ok)
         {
             diagnostics_.device2_successes.fetch_add(1);
@@ -150,43 +350,162 @@ namespace bms
         else
         {
             diagnostics_.device2_failures.fetch_add(1);
+            if (read2.skipped)
+            {
+                diagnostics_.device2_skipped.fetch_add(1);
+            }
         }
 
-        if (dev1_ok && dev2_ok)
+        // Feed each exchange to its device clock estimator and derive the host time at
+        // which the device sampled, instead of stamping after the read returns.
+        HostTimestamp stamp1{};
+        HostTimestamp stamp2{};
+        bool device_ts_valid = true;
+        if (dev1_ok)
         {
+            const DeviceTimestamp ts1 = decode_device_timestamp(regs1);
+            device_ts_valid = device_ts_valid && ts1.valid;
+            stamp1 = clock1_.stamp(ts1, read1.wall_started, read1.wall_finished);
+            export_clock_(clock1_,
+                          diagnostics_.device1_clock_offset_us,
+                          diagnostics_.device1_clock_drift_ppb,
+                          diagnostics_.device1_clock_uncertainty_us);
+        }
+        if (dev2_ok)
+        {
+            const DeviceTimestamp ts2 = decode_device_timestamp(regs2);
+            device_ts_valid = device_ts_valid && ts2.valid;
+            stamp2 = clock2_.stamp(ts2, read2.wall_started, read2.wall_finished);
+            export_clock_(clock2_,
+                          diagnostics_.device2_clock_offset_us,
+                          diagnostics_.device2_clock_drift_ppb,
+                          diagnostics_.device2_clock_uncertainty_us);
+        }
+
+        const bool pair_ok = dev1_ok && dev2_ok;
+        if (!pair_ok)
+        {
+            diagnostics_.pair_failures.fetch_add(1);
+            if (cfg_.enable_sample_logging)
+            {
+                log_failure_(dev1_ok, dev2_ok);
+            }
+        }
+
+        // A single healthy device still yields a degraded sample: its half of the pack is
+        // decoded and the missing half is NaN with the matching flag set.
+        if (pair_ok || (cfg_.publish_partial_samples && (dev1_ok || dev2_ok)))
+        {
+            constexpr float kMissing = std::numeric_limits<float>::quiet_NaN();
+
             VoltageCurrentSample sample;
             sample.sequence = sequence_;
-            sample.timestamp = std::chrono::system_clock::now();
 
-            // Map both register blocks into the unified 15-cell sample layout.
-            // Exact mapping required for stage stabilization:
-            // Device 1 ch0..7  -> cell1..cell8
-            // Device 2 ch0..6  -> cell9..cell15
-            // Device 2 ch7     -> current_a
-            for (std::size_t i = 0; i < 8; ++i)
+            // Device 1 is the time reference of the pack; device 2 stands in when missing.
+            const HostTimestamp &reference = dev1_ok ? stamp1 : stamp2;
+            sample.timestamp = reference.time;
+            sample.time_uncertainty_us = reference.uncertainty_us;
+            if (!reference.from_device_clock)
+            {
+                diagnostics_.host_time_fallbacks.fetch_add(1);
+            }
+            if (!device_ts_valid)
             {
-                sample.cell_voltages[i] = decode_channel_(regs1, i);
+                sample.flags = sample.flags | SampleFlags::TimestampInvalid;
             }
-            for (std::size_t i = 0; i < 7; ++i)
+
+            if (pair_ok)
             {
-                sample.cell_voltages[8 + i] = decode_channel_(regs2, i);
+                // Skew between the two devices' sampling instants: from the disciplined
+                // device clocks when both are valid, else from the exchange midpoints.
+                if (stamp1.from_device_clock && stamp2.from_device_clock)
+                {
+                    sample.device_skew_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                                                stamp2.time - stamp1.time)
+                                                .count();
+                }
+                else
+                {
+                    const auto mid1 = read1.started + (read1.finished - read1.started) / 2;
+                    const auto mid2 = read2.started + (read2.finished - read2.started) / 2;
+                    sample.device_skew_us = std::chrono::duration_cast<std::chrono::microseconds>(mid2 - mid1).count();
+                }
+                diagnostics_.last_device_skew_us.store(sample.device_skew_us);
             }
-            // Decode selected current source channel and convert volts -> amperes.
-            if (cfg_.current_source_channel < 8)
+
+            // Map both register blocks into the unified 15-cell sample layout as declared
+            // by VoltageBoardAMap (cells 1..8) and VoltageBoardBMap (cells 9..15 + sensor).
+            FloatDecodeOptions cell_opts;
+            cell_opts.min = cfg_.cell_voltage_min_v;
+            cell_opts.max = cfg_.cell_voltage_max_v;
+
+            constexpr std::size_t kBoardACells = VoltageBoardAMap::kCellCount;
+            constexpr std::size_t kBoardBCells = VoltageBoardBMap::kCellCount;
+            static_assert(kBoardACells + kBoardBCells == std::tuple_size_v<decltype(sample.cell_voltages)>);
+
+            if (dev1_ok)
             {
-                sample.raw_current_sensor_v = decode_channel_(regs2, cfg_.current_source_channel);
-                sample.current_a = converter_.to_current_a(sample.raw_current_sensor_v);
+                RegisterMapValues<VoltageBoardAMap> board_a{};
+                const auto report = decode_register_map<VoltageBoardAMap>(regs1, board_a, cell_opts);
+                sample.flags = sample.flags | report.flags();
+                std::copy_n(board_a.begin(), kBoardACells, sample.cell_voltages.begin());
             }
             else
             {
-                sample.raw_current_sensor_v = std::numeric_limits<float>::quiet_NaN();
-                sample.current_a = std::numeric_limits<float>::quiet_NaN();
+                std::fill_n(sample.cell_voltages.begin(), kBoardACells, kMissing);
             }
 
-            diagnostics_.pair_successes.fetch_add(1);
-            if (cfg_.enable_sample_logging)
+            if (dev2_ok)
             {
-                log_success_(sample);
+                // Range limits apply to cells only; the current channel is checked for NaN.
+                RegisterMapValues<VoltageBoardBMap> board_b{};
+                const auto report = decode_register_map<VoltageBoardBMap>(regs2, board_b, cell_opts);
+                sample.flags = sample.flags | report.flags((1u << kBoardBCells) - 1u);
+                std::copy_n(board_b.begin(), kBoardBCells, sample.cell_voltages.begin() + kBoardACells);
+
+                // Decode selected current source channel and convert volts -> amperes.
+                if (cfg_.current_source_channel < board_b.size())
+                {
+                    if ((report.non_finite_mask >> cfg_.current_source_channel) & 1u)
+                    {
+                        sample.flags = sample.flags | SampleFlags::DecodeError;
+                    }
+                    sample.raw_current_sensor_v = board_b[cfg_.current_source_channel];
+                    sample.current_a = converter_.to_current_a(sample.raw_current_sensor_v);
+                }
+                else
+                {
+                    sample.raw_current_sensor_v = kMissing;
+                    sample.current_a = kMissing;
+                }
+            }
+            else
+            {
+                std::fill_n(sample.cell_voltages.begin() + kBoardACells, kBoardBCells, kMissing);
+                sample.raw_current_sensor_v = kMissing;
+                sample.current_a = kMissing;
+            }
+
+            if (!dev1_ok)
+            {
+                sample.flags = sample.flags | SampleFlags::Device1Missing | SampleFlags::CommError;
+            }
+            if (!dev2_ok)
+            {
+                sample.flags = sample.flags | SampleFlags::Device2Missing | SampleFlags::CommError;
+            }
+
+            if (pair_ok)
+            {
+                diagnostics_.pair_successes.fetch_add(1);
+                if (cfg_.enable_sample_logging)
+                {
+                    log_success_(sample);
+                }
+            }
+            else
+            {
+                diagnostics_.partial_samples.fetch_add(1);
             }
 
             if (on_sample_)
@@ -195,29 +514,9 @@ namespace bms
                 on_sample_(sample);
             }
         }
-        else
-        {
-            diagnostics_.pair_failures.fetch_add(1);
-            if (cfg_.enable_sample_logging)
-            {
-                log_failure_(dev1_ok, dev2_ok);
-            }
-        }
 
         // Advance sequence even on failed pair reads for consistent diagnostics.
         ++sequence_;
-
-        const auto cycle_end = boost::chrono::steady_clock::now();
-        const auto cycle_duration = boost::chrono::duration_cast<boost::chrono::milliseconds>(
-            cycle_end - cycle_start);
-        diagnostics_.last_cycle_duration_ms.store(cycle_duration.count());
-
-        // Emit aggregated diagnostics at configured cycle intervals.
-        if (cfg_.diagnostics_every_cycles > 0 &&
-            (sequence_ % cfg_.diagnostics_every_cycles) == 0)
-        {
-            log_diagnostics_();
-        }
     }
 
 } // namespace bms
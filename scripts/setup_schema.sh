@@ -43,8 +43,8 @@ fi
 # 4. INITIALIZE TABLES (Schema-on-Write)
 echo -e "\nStep 2: Initializing simplified runtime schemas..."
 
-VOLTAGE_CURRENT_BOOTSTRAP='voltage_current cell1_v=0.0,cell2_v=0.0,cell3_v=0.0,cell4_v=0.0,cell5_v=0.0,cell6_v=0.0,cell7_v=0.0,cell8_v=0.0,cell9_v=0.0,cell10_v=0.0,cell11_v=0.0,cell12_v=0.0,cell13_v=0.0,cell14_v=0.0,cell15_v=0.0,raw_current_sensor_v=0.0,current_a=0.0,sequence=0u'
-TEMPERATURE_BOOTSTRAP='temperature sensor1_c=0.0,sensor2_c=0.0,sensor3_c=0.0,sensor4_c=0.0,sensor5_c=0.0,sensor6_c=0.0,sensor7_c=0.0,sensor8_c=0.0,sensor9_c=0.0,sensor10_c=0.0,sensor11_c=0.0,sensor12_c=0.0,sensor13_c=0.0,sensor14_c=0.0,sensor15_c=0.0,sensor16_c=0.0,sequence=0u'
+VOLTAGE_CURRENT_BOOTSTRAP='voltage_current cell1_v=0.0,cell2_v=0.0,cell3_v=0.0,cell4_v=0.0,cell5_v=0.0,cell6_v=0.0,cell7_v=0.0,cell8_v=0.0,cell9_v=0.0,cell10_v=0.0,cell11_v=0.0,cell12_v=0.0,cell13_v=0.0,cell14_v=0.0,cell15_v=0.0,raw_current_sensor_v=0.0,current_a=0.0,device_skew_us=0i,time_uncertainty_us=0i,flags=0u,sequence=0u'
+TEMPERATURE_BOOTSTRAP='temperature sensor1_c=0.0,sensor2_c=0.0,sensor3_c=0.0,sensor4_c=0.0,sensor5_c=0.0,sensor6_c=0.0,sensor7_c=0.0,sensor8_c=0.0,sensor9_c=0.0,sensor10_c=0.0,sensor11_c=0.0,sensor12_c=0.0,sensor13_c=0.0,sensor14_c=0.0,sensor15_c=0.0,sensor16_c=0.0,time_uncertainty_us=0i,flags=0u,sequence=0u'
 
 echo -n "Configuring voltage_current... "
 WRITE_STATUS=$(curl -s -o /dev/null -w "%{http_code}" \